@@ -0,0 +1,273 @@
+/**
+ *  \file genCorpus.c
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Generator of synthetic Portuguese-like text corpora, used to measure the scaling of the word counter.
+ *
+ *  Words are made of Portuguese syllables; the density of accented letters, the density of punctuation and the
+ *  distribution of the file sizes are controlled from the command line. The output is deterministic for a given
+ *  seed.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <libgen.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <math.h>
+
+/** \brief size of the output buffer of each file */
+#define BUFSIZE      (1 << 16)
+
+/** \brief onsets of the syllables */
+static const char *onsets[] = { "", "", "b", "c", "d", "f", "g", "j", "l", "m", "n", "p", "qu", "r", "s", "t", "v",
+                                "br", "cr", "pr", "tr", "ch", "lh", "nh", "rr", "ss" };
+
+/** \brief plain vowels */
+static const char *vowels[] = { "a", "e", "i", "o", "u", "a", "e", "o" };
+
+/** \brief accented vowels */
+static const char *accented[] = { "á", "é", "í", "ó", "ú", "â", "ê", "ô", "ã", "à" };
+
+/** \brief codas of the syllables */
+static const char *codas[] = { "", "", "", "", "s", "r", "l", "m", "n" };
+
+/** \brief word endings carrying diacritics */
+static const char *endings[] = { "ção", "ções", "ão", "ães", "õe", "ça", "ço" };
+
+/** \brief punctuation following a word */
+static const char *punctuation[] = { ".", ",", ",", ";", ":", "?", "!", " –", " —", "…", "-", "'" };
+
+/** \brief pairs of opening and closing marks around a word */
+static const char *marks[][2] = { { "«", "»" }, { "“", "”" }, { "(", ")" }, { "[", "]" }, { "\"", "\"" } };
+
+/** \brief number of elements of an array */
+#define LEN(x)       ((int) (sizeof (x) / sizeof ((x)[0])))
+
+/** \brief state of the random number generator */
+static uint64_t rngState;
+
+/** \brief print command usage */
+static void printUsage (char *cmdName);
+
+/**
+ *  \brief Get a pseudo random number (xorshift64*).
+ *
+ *  \return random 64 bit number
+ */
+
+static uint64_t rng (void)
+{
+  rngState ^= rngState >> 12;
+  rngState ^= rngState << 25;
+  rngState ^= rngState >> 27;
+  return rngState * 0x2545F4914F6CDD1DULL;
+}
+
+/**
+ *  \brief Get a pseudo random number in [0, 1).
+ *
+ *  \return random number
+ */
+
+static double uniform (void)
+{
+  return (double) (rng () >> 11) / 9007199254740992.0;
+}
+
+/**
+ *  \brief Get a pseudo random element of an array of strings.
+ */
+
+#define PICK(x)      ((x)[rng () % LEN (x)])
+
+/**
+ *  \brief Append a word (and the characters that follow it) to a buffer.
+ *
+ *  \param buf buffer with room for at least 128 bytes
+ *  \param accents probability of each vowel being accented
+ *  \param punct probability of a word being followed by punctuation
+ *
+ *  \return number of bytes appended
+ */
+
+static int genWord (char *buf, double accents, double punct)
+{
+  int n = 0;
+  int nSyllables = 1 + (int) (rng () % 4);
+  const char **mark = (uniform () < punct / 8) ? marks[rng () % LEN (marks)] : NULL;
+
+  if (mark != NULL) n += sprintf (buf + n, "%s", mark[0]);
+  for (int s = 0; s < nSyllables; s++)
+  { n += sprintf (buf + n, "%s", PICK (onsets));
+    n += sprintf (buf + n, "%s", (uniform () < accents) ? PICK (accented) : PICK (vowels));
+    n += sprintf (buf + n, "%s", PICK (codas));
+  }
+  if (uniform () < accents / 4) n += sprintf (buf + n, "%s", PICK (endings));
+  if (mark != NULL) n += sprintf (buf + n, "%s", mark[1]);
+  if (uniform () < punct) n += sprintf (buf + n, "%s", PICK (punctuation));
+  n += sprintf (buf + n, "%s", (rng () % 12 == 0) ? "\n" : " ");
+
+  return n;
+}
+
+/**
+ *  \brief Parse a size, with an optional K, M or G suffix.
+ *
+ *  \param str string to parse
+ *
+ *  \return size in bytes, or -1 if it is not valid
+ */
+
+static double parseSize (const char *str)
+{
+  char *end;
+  double size = strtod (str, &end);
+
+  switch (*end)
+  { case 'k': case 'K': size *= 1024.0; end++; break;
+    case 'm': case 'M': size *= 1024.0 * 1024.0; end++; break;
+    case 'g': case 'G': size *= 1024.0 * 1024.0 * 1024.0; end++; break;
+  }
+  return ((*end != '\0') || (size <= 0)) ? -1 : size;
+}
+
+/**
+ *  \brief Main program.
+ *
+ *  Generates the corpus files named dir/text<i>.txt.
+ *
+ *  \param argc number of words of the command line
+ *  \param argv list of words of the command line
+ *
+ *  \return status of operation
+ */
+
+int main (int argc, char *argv[])
+{
+  char *dir = ".";                                                                    /* directory of the corpus */
+  int nFiles = 8;                                                                            /* number of files */
+  double total = 64.0 * 1024.0 * 1024.0;                                         /* total size of the corpus */
+  double accents = 0.15;                                                 /* probability of an accented vowel */
+  double punct = 0.15;                                              /* probability of punctuation after a word */
+  char *dist = "uniform";                                                      /* distribution of file sizes */
+  unsigned long seed = 1;                                                   /* seed of the number generator */
+  int opt;
+
+  opterr = 0;
+  do
+  { switch ((opt = getopt (argc, argv, "o:n:s:a:p:d:r:h")))
+    { case 'o': dir = optarg;
+                break;
+      case 'n': if ((nFiles = atoi (optarg)) <= 0)
+                   { fprintf (stderr, "%s: non positive number of files\n", basename (argv[0]));
+                     printUsage (basename (argv[0]));
+                     return EXIT_FAILURE;
+                   }
+                break;
+      case 's': if ((total = parseSize (optarg)) < 0)
+                   { fprintf (stderr, "%s: invalid size\n", basename (argv[0]));
+                     printUsage (basename (argv[0]));
+                     return EXIT_FAILURE;
+                   }
+                break;
+      case 'a': accents = atof (optarg);
+                break;
+      case 'p': punct = atof (optarg);
+                break;
+      case 'd': dist = optarg;
+                break;
+      case 'r': seed = strtoul (optarg, NULL, 10);
+                break;
+      case 'h': printUsage (basename (argv[0]));
+                return EXIT_SUCCESS;
+      case '?': fprintf (stderr, "%s: invalid option\n", basename (argv[0]));
+                printUsage (basename (argv[0]));
+                return EXIT_FAILURE;
+      case -1:  break;
+    }
+  } while (opt != -1);
+  if ((strcmp (dist, "uniform") != 0) && (strcmp (dist, "skewed") != 0) && (strcmp (dist, "lognormal") != 0))
+     { fprintf (stderr, "%s: unknown size distribution\n", basename (argv[0]));
+       printUsage (basename (argv[0]));
+       return EXIT_FAILURE;
+     }
+  rngState = 0x9E3779B97F4A7C15ULL ^ seed;
+  if (rngState == 0) rngState = 1;
+
+  /* size of each file, proportional to its weight */
+
+  double *weight;
+  double sum = 0.0;
+  if ((weight = malloc (nFiles * sizeof (double))) == NULL)
+     { fprintf (stderr, "error on allocating space to the file sizes\n");
+       return EXIT_FAILURE;
+     }
+  for (int f = 0; f < nFiles; f++)
+  { if (strcmp (dist, "skewed") == 0) weight[f] = 1.0 / (double) ((f * 7919 % nFiles) + 1);   /* Zipf, shuffled */
+    else if (strcmp (dist, "lognormal") == 0)
+            weight[f] = exp (sqrt (-2.0 * log (1.0 - uniform ())) * cos (2.0 * M_PI * uniform ()));
+    else weight[f] = 1.0;
+    sum += weight[f];
+  }
+
+  char *buf;
+  if ((buf = malloc (BUFSIZE + 128)) == NULL)
+     { fprintf (stderr, "error on allocating space to the output buffer\n");
+       return EXIT_FAILURE;
+     }
+  for (int f = 0; f < nFiles; f++)
+  { char name[4096];
+    FILE *fp;
+    double size = total * weight[f] / sum;
+    double written = 0.0;
+
+    snprintf (name, sizeof (name), "%s/text%d.txt", dir, f);
+    if ((fp = fopen (name, "wb")) == NULL)
+       { perror (name);
+         return EXIT_FAILURE;
+       }
+    while (written < size)
+    { int n = 0;
+      while ((n < BUFSIZE) && (written + n < size))
+        n += genWord (buf + n, accents, punct);
+      if (fwrite (buf, 1, n, fp) != (size_t) n)
+         { perror (name);
+           return EXIT_FAILURE;
+         }
+      written += n;
+    }
+    fclose (fp);
+    printf ("%s\n", name);
+  }
+  free (buf);
+  free (weight);
+
+  return EXIT_SUCCESS;
+}
+
+/**
+ *  \brief Print command usage.
+ *
+ *  A message specifying how the program should be called is printed.
+ *
+ *  \param cmdName string with the name of the command
+ */
+
+static void printUsage (char *cmdName)
+{
+  fprintf (stderr, "\nSynopsis: %s [OPTIONS]\n"
+           "  OPTIONS:\n"
+           "  -h           --- print this help\n"
+           "  -o dir       --- directory of the corpus (default: .)\n"
+           "  -n nFiles    --- number of files (default: 8)\n"
+           "  -s size      --- total size, with an optional K, M or G suffix (default: 64M)\n"
+           "  -a density   --- probability of a vowel being accented (default: 0.15)\n"
+           "  -p density   --- probability of a word being followed by punctuation (default: 0.15)\n"
+           "  -d dist      --- distribution of the file sizes: uniform, skewed or lognormal (default: uniform)\n"
+           "  -r seed      --- seed of the random number generator (default: 1)\n", cmdName);
+}
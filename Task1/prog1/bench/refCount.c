@@ -0,0 +1,195 @@
+/**
+ *  \file refCount.c
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Reference word counter, used to check the results of the word counter under every plan.
+ *
+ *  It shares no code with the word counter: each file is read whole and scanned once, one character at a time,
+ *  with its own UTF-8 decoder (the well-formed byte sequences of RFC 3629; any other byte is a Windows-1252
+ *  character and an invalid sequence) and its own character classification. The results are printed in the CSV
+ *  format of the word counter.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <libgen.h>
+
+/** \brief number of elements of an array */
+#define LEN(x)       ((int) (sizeof (x) / sizeof ((x)[0])))
+
+/** \brief characters which separate words: white space, punctuation, dashes, ellipsis, brackets and quotes */
+static const int separators[] = { ' ', '\t', '\n', '\r', '.', ',', ':', ';', '?', '!', '-', 0x2013, 0x2014, 0x2026,
+                                  '(', ')', '[', ']', '"', 0x201C, 0x201D, 0xAB, 0xBB, 0xA0 };
+
+/** \brief apostrophes: they neither start nor end a word */
+static const int apostrophes[] = { '\'', 0x2018, 0x2019 };
+
+/** \brief letters of interest (A, E, I, O, U, Y and Ç), each with its plain and accented forms, ended by -1 */
+static const int letters[7][11] = {
+  { 'a', 'A', 0xE0, 0xE1, 0xE2, 0xE3, 0xC0, 0xC1, 0xC2, 0xC3, -1 },                 /* à á â ã À Á Â Ã */
+  { 'e', 'E', 0xE8, 0xE9, 0xEA, 0xC8, 0xC9, 0xCA, -1 },                                   /* è é ê È É Ê */
+  { 'i', 'I', 0xEC, 0xED, 0xCC, 0xCD, -1 },                                                     /* ì í Ì Í */
+  { 'o', 'O', 0xF2, 0xF3, 0xF4, 0xF5, 0xD2, 0xD3, 0xD4, 0xD5, -1 },                 /* ò ó ô õ Ò Ó Ô Õ */
+  { 'u', 'U', 0xF9, 0xFA, 0xD9, 0xDA, -1 },                                                     /* ù ú Ù Ú */
+  { 'y', 'Y', -1 },
+  { 0xE7, 0xC7, -1 }                                                                                 /* ç Ç */
+};
+
+/** \brief code points of the bytes 0x80 to 0x9F in Windows-1252 (undefined bytes stand for themselves) */
+static const int windows1252[32] = {
+  0x20AC, 0x81, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021, 0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x8D,
+  0x017D, 0x8F, 0x90, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014, 0x02DC, 0x2122, 0x0161, 0x203A,
+  0x0153, 0x9D, 0x017E, 0x0178
+};
+
+/**
+ *  \brief Check if a code point is in a list.
+ *
+ *  \param cp code point
+ *  \param list list of code points, possibly ended by -1
+ *  \param n maximum number of code points of the list
+ *
+ *  \return true if it is
+ */
+
+static bool isIn (int cp, const int *list, int n)
+{
+  for (int k = 0; (k < n) && (list[k] != -1); k++)
+    if (list[k] == cp) return true;
+  return false;
+}
+
+/**
+ *  \brief Get the next character of a text.
+ *
+ *  \param s text
+ *  \param n number of bytes of the text
+ *  \param p position of the character, advanced past it
+ *  \param bad set to true if the character is not well-formed UTF-8
+ *
+ *  \return code point
+ */
+
+static int nextChar (const unsigned char *s, size_t n, size_t *p, bool *bad)
+{
+  unsigned char b = s[*p];
+  int len = 0, cp = 0;
+  unsigned char lo = 0x80, hi = 0xBF;                                             /* range of the second byte */
+
+  if (b <= 0x7F) len = 1, cp = b;
+  else if ((b >= 0xC2) && (b <= 0xDF)) len = 2, cp = b & 0x1F;
+  else if ((b >= 0xE0) && (b <= 0xEF)) len = 3, cp = b & 0x0F;
+  else if ((b >= 0xF0) && (b <= 0xF4)) len = 4, cp = b & 0x07;
+  if (b == 0xE0) lo = 0xA0;
+  else if (b == 0xED) hi = 0x9F;
+  else if (b == 0xF0) lo = 0x90;
+  else if (b == 0xF4) hi = 0x8F;
+
+  *bad = (len == 0) || (*p + len > n);
+  for (int k = 1; !*bad && (k < len); k++)
+  { unsigned char c = s[*p + k];
+    if ((c < ((k == 1) ? lo : 0x80)) || (c > ((k == 1) ? hi : 0xBF))) *bad = true;
+    cp = (cp << 6) | (c & 0x3F);
+  }
+  if (*bad)
+     { *p += 1;
+       return ((b >= 0x80) && (b <= 0x9F)) ? windows1252[b - 0x80] : b;
+     }
+  *p += len;
+  return cp;
+}
+
+/**
+ *  \brief Count a file and print its results in CSV.
+ *
+ *  \param name name of the file
+ *
+ *  \return true if the file could be read
+ */
+
+static bool countFile (const char *name)
+{
+  FILE *fp;
+  unsigned char *text = NULL;
+  size_t n = 0, size = 0, got;
+
+  if ((fp = fopen (name, "rb")) == NULL)
+     { perror (name);
+       return false;
+     }
+  do
+  { if (n == size)
+       { size = 2 * size + (1 << 20);
+         if ((text = realloc (text, size)) == NULL)
+            { fprintf (stderr, "error on allocating space to the text\n");
+              exit (EXIT_FAILURE);
+            }
+       }
+    n += (got = fread (text + n, 1, size - n, fp));
+  } while (got > 0);
+  fclose (fp);
+
+  long words = 0, invalid = 0, withLetter[7] = { 0 };
+  bool inWord = false, seen[7] = { false };
+  size_t p = 0;
+  bool bad;
+
+  while (p < n)
+  { int cp = nextChar (text, n, &p, &bad);
+    if (bad) invalid += 1;
+    if (isIn (cp, separators, LEN (separators)))
+       { inWord = false;
+         memset (seen, 0, sizeof (seen));
+         continue;
+       }
+    if (!inWord && !isIn (cp, apostrophes, LEN (apostrophes)))                  /* any other character starts one */
+       { inWord = true;
+         words += 1;
+       }
+    for (int l = 0; l < 7; l++)                                                /* each letter once in a word */
+      if (!seen[l] && isIn (cp, letters[l], LEN (letters[l])))
+         { seen[l] = true;
+           withLetter[l] += 1;
+         }
+  }
+  free (text);
+
+  putchar ('"');
+  for (const char *c = name; *c != '\0'; c++)
+    if (*c == '"') printf ("\"\"");
+    else putchar (*c);
+  printf ("\",%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld\n", words, withLetter[0], withLetter[1], withLetter[2],
+          withLetter[3], withLetter[4], withLetter[5], withLetter[6], invalid);
+  return true;
+}
+
+/**
+ *  \brief Main program.
+ *
+ *  Prints the results of each file given, in CSV, with the header of the word counter.
+ *
+ *  \param argc number of words of the command line
+ *  \param argv list of words of the command line
+ *
+ *  \return status of operation
+ */
+
+int main (int argc, char *argv[])
+{
+  int status = EXIT_SUCCESS;
+
+  if (argc < 2)
+     { fprintf (stderr, "\nSynopsis: %s file...\n", basename (argv[0]));
+       return EXIT_FAILURE;
+     }
+  printf ("file,words,a,e,i,o,u,y,c,invalid\n");
+  for (int f = 1; f < argc; f++)
+    if (!countFile (argv[f])) status = EXIT_FAILURE;
+
+  return status;
+}
@@ -0,0 +1,89 @@
+#!/bin/bash
+#
+#  Scaling and regression harness of the word counter.
+#
+#  Builds the counter and the corpus generator, generates a synthetic corpus, and runs the counter from 1 to
+#  maxThreads worker threads under the split, per file and pipeline plans (the pipeline with one read and one split
+#  thread and that many count threads). Every run, the sequential one included, is checked against the results of
+#  refCount, a reference counter which shares no code with it; the elapsed time, throughput, speedup over the
+#  sequential plan, peak memory and worker idle time of each run are stored as CSV.
+#  Each plan is run once more at maxThreads with the files scheduled in the order given (plan-given), to measure
+#  what the largest first scheduling saves on skewed file sizes.
+#
+#  Usage: scaling.sh [-s size] [-n nFiles] [-d dist] [-a accents] [-t maxThreads] [-w workDir] [-o results.csv]
+#
+#  The exit status is non zero if any run disagrees with the reference.
+#
+#  Authors: João Morais and Miguel Ferreira
+
+SRC="$(cd "$(dirname "$0")/.." && pwd)"
+SIZE=256M
+NFILES=16
+DIST=uniform
+ACCENTS=0.15
+MAXTHREADS=$(nproc)
+WORK=${TMPDIR:-/tmp}/cle-scaling
+OUT=scaling.csv
+
+while getopts "s:n:d:a:t:w:o:h" opt; do
+  case $opt in
+    s) SIZE=$OPTARG ;;
+    n) NFILES=$OPTARG ;;
+    d) DIST=$OPTARG ;;
+    a) ACCENTS=$OPTARG ;;
+    t) MAXTHREADS=$OPTARG ;;
+    w) WORK=$OPTARG ;;
+    o) OUT=$OPTARG ;;
+    *) sed -n '/^#  Usage/p' "$0"; exit 1 ;;
+  esac
+done
+
+mkdir -p "$WORK/corpus" || exit 1
+gcc -Wall -O3 -o "$WORK/main" $(ls "$SRC"/*.c) -lpthread -lm -lrt || exit 1
+gcc -Wall -O3 -o "$WORK/genCorpus" "$SRC/bench/genCorpus.c" -lm || exit 1
+gcc -Wall -O3 -o "$WORK/refCount" "$SRC/bench/refCount.c" || exit 1
+rm -f "$WORK"/corpus/*.txt
+FILES=$("$WORK/genCorpus" -o "$WORK/corpus" -n "$NFILES" -s "$SIZE" -d "$DIST" -a "$ACCENTS") || exit 1
+BYTES=$(cat $FILES | wc -c)
+
+# run plan threads [options]: runs the counter, leaving the sorted results in $WORK/run.csv and setting SECONDS_,
+# RSS and IDLE
+run () {
+  "$WORK/main" -v -f csv -x "$1" -t "$2" $3 $FILES 2> "$WORK/run.err" | sort > "$WORK/run.csv"
+  SECONDS_=$(sed -n 's/^Elapsed time = \([0-9.]*\) s$/\1/p' "$WORK/run.err")
+  RSS=$(sed -n 's/^Peak resident set size = \([0-9]*\) KiB$/\1/p' "$WORK/run.err")
+  IDLE=$(sed -n 's/^Worker idle time = .* (\([0-9.]*\)% of the worker time)$/\1/p' "$WORK/run.err")
+}
+
+"$WORK/refCount" $FILES | sort > "$WORK/reference.csv" || exit 1
+run seq 1
+REFSECONDS=$SECONDS_
+
+STATUS=0
+echo "plan,threads,seconds,mb_per_s,speedup,peak_rss_kib,idle_pct,correct" > "$OUT"
+# row plan threads correct: appends a row of results to the CSV file
+row () {
+  awk -v p="$1" -v t="$2" -v s="$SECONDS_" -v r="$REFSECONDS" -v b="$BYTES" -v m="$RSS" -v i="${IDLE:-0}" -v c="$3" \
+      'BEGIN { printf "%s,%d,%.6f,%.1f,%.2f,%d,%.1f,%s\n", p, t, s, b / 1048576 / s, r / s, m, i, c }' >> "$OUT"
+}
+
+if cmp -s "$WORK/run.csv" "$WORK/reference.csv"; then correct=yes; else correct=no; STATUS=1; fi
+row seq 1 "$correct"
+for plan in split file pipe; do
+  t=1
+  while [ "$t" -le "$MAXTHREADS" ]; do
+    run "$plan" "$t"
+    if cmp -s "$WORK/run.csv" "$WORK/reference.csv"; then correct=yes; else correct=no; STATUS=1; fi
+    row "$plan" "$t" "$correct"
+    [ "$t" -eq "$MAXTHREADS" ] && break
+    t=$((t * 2))
+    [ "$t" -gt "$MAXTHREADS" ] && t=$MAXTHREADS
+  done
+  run "$plan" "$MAXTHREADS" -a
+  if cmp -s "$WORK/run.csv" "$WORK/reference.csv"; then correct=yes; else correct=no; STATUS=1; fi
+  row "$plan-given" "$MAXTHREADS" "$correct"
+done
+
+cat "$OUT"
+[ "$STATUS" -ne 0 ] && echo "results differ from the reference counter" >&2
+exit $STATUS
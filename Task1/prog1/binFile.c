@@ -0,0 +1,130 @@
+/**
+ *  \file binFile.c (implementation file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Binary files: integers stored little-endian, one byte at a time, so the shards, chunk indexes and checkpoints
+ *  can be read on any machine.
+ *
+ *  Definition of the operations:
+ *     \li putInt32
+ *     \li putInt64
+ *     \li getInt32
+ *     \li getInt64.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "binFile.h"
+
+/**
+ *  \brief Write an unsigned integer, least significant byte first.
+ *
+ *  Internal operation.
+ *
+ *  \param fp stream to write to
+ *  \param val value to write
+ *  \param n number of bytes
+ *
+ *  \return true on success
+ */
+
+static bool putBytes (FILE *fp, uint64_t val, int n)
+{
+  unsigned char buf[8];
+
+  for (int k = 0; k < n; k++)
+    buf[k] = (unsigned char) (val >> (8 * k));
+  return fwrite (buf, n, 1, fp) == 1;
+}
+
+/**
+ *  \brief Read an unsigned integer, least significant byte first.
+ *
+ *  Internal operation.
+ *
+ *  \param fp stream to read from
+ *  \param val returns the value read
+ *  \param n number of bytes
+ *
+ *  \return true on success, false on a truncated file
+ */
+
+static bool getBytes (FILE *fp, uint64_t *val, int n)
+{
+  unsigned char buf[8];
+
+  if (fread (buf, n, 1, fp) != 1) return false;
+  *val = 0;
+  for (int k = n - 1; k >= 0; k--)
+    *val = (*val << 8) | buf[k];
+  return true;
+}
+
+/**
+ *  \brief Write a 32 bit integer.
+ *
+ *  \param fp stream to write to
+ *  \param val value to write
+ *
+ *  \return true on success
+ */
+
+bool putInt32 (FILE *fp, int32_t val)
+{
+  return putBytes (fp, (uint32_t) val, 4);
+}
+
+/**
+ *  \brief Write a 64 bit integer.
+ *
+ *  \param fp stream to write to
+ *  \param val value to write
+ *
+ *  \return true on success
+ */
+
+bool putInt64 (FILE *fp, long long val)
+{
+  return putBytes (fp, (uint64_t) (int64_t) val, 8);
+}
+
+/**
+ *  \brief Read a 32 bit integer.
+ *
+ *  \param fp stream to read from
+ *  \param val returns the value read
+ *
+ *  \return true on success, false on a truncated file
+ */
+
+bool getInt32 (FILE *fp, int32_t *val)
+{
+  uint64_t v;
+
+  if (!getBytes (fp, &v, 4)) return false;
+  *val = (int32_t) (uint32_t) v;                                           /* two's complement, as it was written */
+  return true;
+}
+
+/**
+ *  \brief Read a 64 bit integer.
+ *
+ *  \param fp stream to read from
+ *  \param val returns the value read
+ *
+ *  \return true on success, false on a truncated file
+ */
+
+bool getInt64 (FILE *fp, long long *val)
+{
+  uint64_t v;
+
+  if (!getBytes (fp, &v, 8)) return false;
+  *val = (long long) (int64_t) v;
+  return true;
+}
@@ -0,0 +1,65 @@
+/**
+ *  \file binFile.h (interface file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Binary files: integers stored little-endian, one byte at a time, so the shards, chunk indexes and checkpoints
+ *  can be read on any machine.
+ *
+ *  Definition of the operations:
+ *     \li putInt32
+ *     \li putInt64
+ *     \li getInt32
+ *     \li getInt64.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#ifndef BINFILE_H
+#define BINFILE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ *  \brief Write a 32 bit integer.
+ *
+ *  \param fp stream to write to
+ *  \param val value to write
+ *
+ *  \return true on success
+ */
+extern bool putInt32 (FILE *fp, int32_t val);
+
+/**
+ *  \brief Write a 64 bit integer.
+ *
+ *  \param fp stream to write to
+ *  \param val value to write
+ *
+ *  \return true on success
+ */
+extern bool putInt64 (FILE *fp, long long val);
+
+/**
+ *  \brief Read a 32 bit integer.
+ *
+ *  \param fp stream to read from
+ *  \param val returns the value read
+ *
+ *  \return true on success, false on a truncated file
+ */
+extern bool getInt32 (FILE *fp, int32_t *val);
+
+/**
+ *  \brief Read a 64 bit integer.
+ *
+ *  \param fp stream to read from
+ *  \param val returns the value read
+ *
+ *  \return true on success, false on a truncated file
+ */
+extern bool getInt64 (FILE *fp, long long *val);
+
+#endif /* BINFILE_H */
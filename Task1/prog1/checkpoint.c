@@ -0,0 +1,378 @@
+/**
+ *  \file checkpoint.c (implementation file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Checkpoints of a run, to resume it without counting again what was already counted.
+ *
+ *  The progress of the files is recorded in memory by whoever counts them, and written to disk at most once every
+ *  CKPTPERIOD seconds. Between checkpoints a counting thread only reads the clock once per chunk, so the cost of
+ *  taking them is well under 1% of the run.
+ *
+ *  Definition of the operations:
+ *     \li checkpointInit
+ *     \li checkpointLoad
+ *     \li checkpointDue
+ *     \li checkpointFile
+ *     \li checkpointRestore
+ *     \li checkpointWrite.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "probConst.h"
+#include "dataStructures.h"
+#include "checkpoint.h"
+#include "patterns.h"
+#include "binFile.h"
+#include "utils.h"
+
+/** \brief flag signaling decomposed diacritics must be composed before counting */
+extern bool normalizeNFC;
+
+/** \brief flag signaling checkpoints are being taken */
+bool checkpointing = false;
+
+/** \brief checkpoint identification */
+static const char magic[4] = { 'C', 'L', 'C', '3' };
+
+/**
+ * \brief Struct to store the progress of a file
+ */
+typedef struct
+{
+    int state;
+    off_t offset;
+    off_t fileBytes;
+    long long mtime;
+    long mtimeNsec;
+    int nameBytes;
+    int tailBytes;
+    TempResults res;
+} FileRecord;
+
+/** \brief name of the checkpoint */
+static const char *ckptPath;
+
+/** \brief number of files */
+static int nFiles;
+
+/** \brief names of the files */
+static char **fNames;
+
+/** \brief bytes of the previous chunk kept in front of each chunk */
+static int ckptContext;
+
+/** \brief progress of each file */
+static FileRecord *records;
+
+/** \brief occurrences of the patterns in the bytes counted of each file */
+static int *counts;
+
+/** \brief end of the last chunk counted of each file */
+static unsigned char *tails;
+
+/** \brief copy of the progress of each file, being written */
+static FileRecord *snapRecords;
+
+/** \brief copy of the occurrences of the patterns, being written */
+static int *snapCounts;
+
+/** \brief copy of the ends of the last chunks, being written */
+static unsigned char *snapTails;
+
+/** \brief time the last checkpoint was written */
+static double lastWrite;
+
+/** \brief locking flag which warrants mutual exclusion on the progress of the files */
+static pthread_mutex_t accessCR = PTHREAD_MUTEX_INITIALIZER;
+
+/** \brief locking flag which warrants mutual exclusion on the checkpoint file and the copies being written */
+static pthread_mutex_t accessFile = PTHREAD_MUTEX_INITIALIZER;
+
+/** \brief name of the critical regions, for error reporting */
+static const char region[] = "checkpoint region";
+
+/**
+ *  \brief Write the record of a file.
+ *
+ *  Internal operation.
+ *
+ *  \param fp stream to write to
+ *  \param rec record of the file
+ *
+ *  \return true on success
+ */
+
+static bool putRecord (FILE *fp, FileRecord *rec)
+{
+  return putInt32 (fp, rec->state) && putInt64 (fp, rec->offset) && putInt64 (fp, rec->fileBytes) &&
+         putInt64 (fp, rec->mtime) && putInt64 (fp, rec->mtimeNsec) && putInt32 (fp, rec->nameBytes) &&
+         putInt32 (fp, rec->tailBytes) && putInt64 (fp, rec->res.nWords) && putInt64 (fp, rec->res.a) &&
+         putInt64 (fp, rec->res.e) && putInt64 (fp, rec->res.i) && putInt64 (fp, rec->res.o) &&
+         putInt64 (fp, rec->res.u) && putInt64 (fp, rec->res.c) && putInt64 (fp, rec->res.y) &&
+         putInt64 (fp, rec->res.nInvalid);
+}
+
+/**
+ *  \brief Read the record of a file.
+ *
+ *  Internal operation.
+ *
+ *  \param fp stream to read from
+ *  \param rec returns the record of the file
+ *
+ *  \return true on success, false on a truncated checkpoint
+ */
+
+static bool getRecord (FILE *fp, FileRecord *rec)
+{
+  long long offset, fileBytes, mtimeNsec;
+
+  memset (rec, 0, sizeof (FileRecord));
+  if (!getInt32 (fp, &rec->state) || !getInt64 (fp, &offset) || !getInt64 (fp, &fileBytes) ||
+      !getInt64 (fp, &rec->mtime) || !getInt64 (fp, &mtimeNsec) || !getInt32 (fp, &rec->nameBytes) ||
+      !getInt32 (fp, &rec->tailBytes) || !getInt64 (fp, &rec->res.nWords) || !getInt64 (fp, &rec->res.a) ||
+      !getInt64 (fp, &rec->res.e) || !getInt64 (fp, &rec->res.i) || !getInt64 (fp, &rec->res.o) ||
+      !getInt64 (fp, &rec->res.u) || !getInt64 (fp, &rec->res.c) || !getInt64 (fp, &rec->res.y) ||
+      !getInt64 (fp, &rec->res.nInvalid))
+     return false;
+  rec->offset = (off_t) offset;
+  rec->fileBytes = (off_t) fileBytes;
+  rec->mtimeNsec = (long) mtimeNsec;
+  return true;
+}
+
+/**
+ *  \brief Start taking checkpoints of a list of files.
+ *
+ *  \param path name of the checkpoint
+ *  \param numFiles number of files
+ *  \param fileNames names of the files
+ *  \param context number of bytes of the previous chunk kept in front of each chunk
+ */
+
+void checkpointInit (const char *path, int numFiles, char *fileNames[], int context)
+{
+  ckptPath = path;
+  nFiles = numFiles;
+  fNames = fileNames;
+  ckptContext = context;
+  if (((records = calloc (nFiles + 1, sizeof (FileRecord))) == NULL) ||
+      ((counts = calloc ((size_t) nFiles * nPatterns + 1, sizeof (int))) == NULL) ||
+      ((tails = malloc ((size_t) nFiles * context + 1)) == NULL) ||
+      ((snapRecords = malloc ((nFiles + 1) * sizeof (FileRecord))) == NULL) ||
+      ((snapCounts = malloc (((size_t) nFiles * nPatterns + 1) * sizeof (int))) == NULL) ||
+      ((snapTails = malloc ((size_t) nFiles * context + 1)) == NULL))
+     { fprintf (stderr, "error on allocating space to the checkpoint\n");
+       exit (EXIT_FAILURE);
+     }
+  for (int f = 0; f < nFiles; f++)
+    records[f].state = CKPT_PENDING;
+  lastWrite = now ();
+  checkpointing = true;
+}
+
+/**
+ *  \brief Load the last checkpoint, to resume the run it was taken from.
+ *
+ *  The run is aborted if the checkpoint was taken with other files, options or patterns, or if any file changed
+ *  since.
+ *
+ *  \return true if there was a checkpoint to resume from
+ */
+
+bool checkpointLoad (void)
+{
+  char id[4];
+  int32_t hdr[4];                                             /* files, patterns, bytes of context and NFC flag */
+  FILE *fp;
+  bool valid;
+  char *name;
+
+  if ((fp = fopen (ckptPath, "rb")) == NULL) return false;
+  valid = (fread (id, sizeof (id), 1, fp) == 1) && (memcmp (id, magic, sizeof (magic)) == 0) &&
+          getInt32 (fp, &hdr[0]) && getInt32 (fp, &hdr[1]) && getInt32 (fp, &hdr[2]) && getInt32 (fp, &hdr[3]) &&
+          (hdr[0] == nFiles) && (hdr[1] == nPatterns) && (hdr[2] == ckptContext) && (hdr[3] == normalizeNFC);
+  for (int f = 0; valid && (f < nFiles); f++)
+  { FileRecord *rec = &records[f];
+    int *fileCounts = counts + (size_t) f * nPatterns;
+    struct stat st;
+    valid = getRecord (fp, rec) && (rec->nameBytes == (int) strlen (fNames[f])) &&
+            (rec->tailBytes >= 0) && (rec->tailBytes <= ckptContext) &&
+            ((name = malloc (rec->nameBytes + 1)) != NULL);
+    if (!valid) break;
+    valid = (fread (name, 1, rec->nameBytes, fp) == (size_t) rec->nameBytes) &&
+            (memcmp (name, fNames[f], rec->nameBytes) == 0);
+    for (int k = 0; valid && (k < nPatterns); k++)
+      valid = getInt32 (fp, &fileCounts[k]);
+    valid = valid && (fread (tails + (size_t) f * ckptContext, 1, rec->tailBytes, fp) == (size_t) rec->tailBytes) &&
+            ((rec->state == CKPT_PENDING) ||
+             ((stat (fNames[f], &st) == 0) && (st.st_size == rec->fileBytes) && (st.st_mtim.tv_sec == rec->mtime) &&
+              (st.st_mtim.tv_nsec == rec->mtimeNsec)));
+    free (name);
+  }
+  fclose (fp);
+  if (!valid)
+     { fprintf (stderr, "%s: the checkpoint does not match the files or options of this run\n", ckptPath);
+       exit (EXIT_FAILURE);
+     }
+  return true;
+}
+
+/**
+ *  \brief Check if a checkpoint is due, CKPTPERIOD seconds after the last one of the caller.
+ *
+ *  \param last time of the last checkpoint of the caller, updated if one is due (0 to start counting)
+ *
+ *  \return true if a checkpoint is due
+ */
+
+bool checkpointDue (double *last)
+{
+  double t = now ();
+
+  if (*last == 0.0) *last = t;
+  if (t - *last < CKPTPERIOD) return false;
+  *last = t;
+  return true;
+}
+
+/**
+ *  \brief Record the progress of a file.
+ *
+ *  \param fileID file identification
+ *  \param state CKPT_PARTIAL or CKPT_DONE
+ *  \param offset number of bytes of the file already counted
+ *  \param res results of those bytes
+ *  \param chunk last chunk counted (NULL if no context is kept)
+ */
+
+void checkpointFile (int fileID, int state, off_t offset, TempResults *res, Chunk *chunk)
+{
+  FileRecord *rec = &records[fileID];
+  int tail = 0;                                                                /* bytes of the last chunk kept */
+
+  if ((chunk != NULL) && (state == CKPT_PARTIAL))
+     tail = (chunk->numBytes < ckptContext) ? chunk->numBytes : ckptContext;
+  lock (&accessCR, region);
+  rec->state = state;
+  rec->offset = offset;
+  rec->res = *res;
+  rec->res.patternCounts = NULL;
+  if (res->patternCounts != NULL)
+     memcpy (counts + (size_t) fileID * nPatterns, res->patternCounts, nPatterns * sizeof (int));
+  rec->tailBytes = tail;
+  if (tail > 0) memcpy (tails + (size_t) fileID * ckptContext, chunk->textChunk + chunk->numBytes - tail, tail);
+  unlock (&accessCR, region);
+}
+
+/**
+ *  \brief Get the progress of a file recorded by the checkpoint being resumed.
+ *
+ *  \param fileID file identification
+ *  \param offset returns the number of bytes of the file already counted
+ *  \param res returns the results of those bytes (the occurrences of the patterns are copied to the array of the
+ *         caller, if any)
+ *  \param chunk returns the end of the last chunk counted, to be kept in front of the next one
+ *
+ *  \return state of the file: CKPT_PENDING, CKPT_PARTIAL or CKPT_DONE
+ */
+
+int checkpointRestore (int fileID, off_t *offset, TempResults *res, Chunk *chunk)
+{
+  FileRecord *rec = &records[fileID];
+  int *patternCounts = res->patternCounts;
+
+  if (!checkpointing) return CKPT_PENDING;
+  lock (&accessCR, region);
+  if (rec->state == CKPT_PENDING)
+     { unlock (&accessCR, region);
+       return CKPT_PENDING;
+     }
+  *offset = rec->offset;
+  *res = rec->res;
+  res->fileID = fileID;
+  res->patternCounts = patternCounts;
+  if (patternCounts != NULL)
+     memcpy (patternCounts, counts + (size_t) fileID * nPatterns, nPatterns * sizeof (int));
+  memcpy (chunk->textChunk, tails + (size_t) fileID * ckptContext, rec->tailBytes);
+  chunk->numBytes = rec->tailBytes;
+  chunk->overlap = 0;
+  int state = rec->state;
+  unlock (&accessCR, region);
+
+  return state;
+}
+
+/**
+ *  \brief Write the copy of the progress, as the contents of the checkpoint file.
+ *
+ *  Internal operation.
+ *
+ *  \param fp stream to write to
+ *  \param arg unused
+ *
+ *  \return true on success
+ */
+
+static bool putSnapshot (FILE *fp, void *arg)
+{
+  bool ok;
+
+  (void) arg;
+  ok = (fwrite (magic, sizeof (magic), 1, fp) == 1) && putInt32 (fp, nFiles) && putInt32 (fp, nPatterns) &&
+       putInt32 (fp, ckptContext) && putInt32 (fp, normalizeNFC);
+  for (int f = 0; ok && (f < nFiles); f++)
+  { FileRecord *rec = &snapRecords[f];
+    struct stat st;
+    if ((rec->state != CKPT_PENDING) && (stat (fNames[f], &st) == 0))      /* identify the version of the file */
+       { rec->fileBytes = st.st_size;
+         rec->mtime = st.st_mtim.tv_sec;
+         rec->mtimeNsec = st.st_mtim.tv_nsec;
+       }
+    rec->nameBytes = (int) strlen (fNames[f]);
+    ok = putRecord (fp, rec) && (fwrite (fNames[f], 1, rec->nameBytes, fp) == (size_t) rec->nameBytes);
+    for (int k = 0; ok && (k < nPatterns); k++)
+      ok = putInt32 (fp, snapCounts[(size_t) f * nPatterns + k]);
+    ok = ok && (fwrite (snapTails + (size_t) f * ckptContext, 1, rec->tailBytes, fp) == (size_t) rec->tailBytes);
+  }
+
+  return ok;
+}
+
+/**
+ *  \brief Write a checkpoint with the progress recorded so far.
+ *
+ *  The progress is copied under the lock and written without it, so the threads recording theirs do not wait for
+ *  the disk. The checkpoint file is replaced whole, so a failed checkpoint leaves the last one.
+ *
+ *  \param force flag signaling the checkpoint must be written even if the last one is recent
+ */
+
+void checkpointWrite (bool force)
+{
+  lock (&accessFile, region);
+  if (!force && (now () - lastWrite < CKPTPERIOD))                       /* another thread has just written one */
+     { unlock (&accessFile, region);
+       return;
+     }
+  lock (&accessCR, region);
+  memcpy (snapRecords, records, nFiles * sizeof (FileRecord));
+  memcpy (snapCounts, counts, (size_t) nFiles * nPatterns * sizeof (int));
+  memcpy (snapTails, tails, (size_t) nFiles * ckptContext);
+  unlock (&accessCR, region);
+
+  if (!replaceFile (ckptPath, putSnapshot, NULL)) perror (ckptPath);
+  lastWrite = now ();
+  unlock (&accessFile, region);
+}
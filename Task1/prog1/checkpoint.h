@@ -0,0 +1,105 @@
+/**
+ *  \file checkpoint.h (interface file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Checkpoints of a run: the files already counted, and for each file being counted the number of bytes counted so
+ *  far, their results and the end of the last chunk (the context of the next one), so that a run which was
+ *  interrupted can be resumed without counting again what was already counted.
+ *
+ *  Since chunks end at word boundaries, the byte offset and the end of the last chunk are the whole state of the
+ *  counting of a file: resuming from them gives exactly the same chunks, and the same results, as an uninterrupted
+ *  run.
+ *
+ *  Checkpoint layout (integers little-endian):
+ *     \li magic "CLC3", the number of files and patterns, the bytes of context and the NFC flag, as 32 bit integers
+ *     \li for each file, its state, as a 32 bit integer, the offset, size and modification time of the file (seconds
+ *         and nanoseconds), as 64 bit integers, the length of its name and of the end of the last chunk, as 32 bit
+ *         integers, and the nine counters (words, A, E, I, O, U, C, Y and invalid sequences), as 64 bit integers,
+ *         then the name, the occurrences of the patterns, as 32 bit integers, and the end of the last chunk.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+#include "dataStructures.h"
+
+/** \brief file not counted yet */
+#define CKPT_PENDING   0
+
+/** \brief file partially counted */
+#define CKPT_PARTIAL   1
+
+/** \brief file counted */
+#define CKPT_DONE      2
+
+/** \brief flag signaling checkpoints are being taken */
+extern bool checkpointing;
+
+/**
+ *  \brief Start taking checkpoints of a list of files.
+ *
+ *  \param path name of the checkpoint
+ *  \param nFiles number of files
+ *  \param fileNames names of the files
+ *  \param context number of bytes of the previous chunk kept in front of each chunk
+ */
+extern void checkpointInit (const char *path, int nFiles, char *fileNames[], int context);
+
+/**
+ *  \brief Load the last checkpoint, to resume the run it was taken from.
+ *
+ *  The run is aborted if the checkpoint was taken with other files, options or patterns, or if any file changed
+ *  since.
+ *
+ *  \return true if there was a checkpoint to resume from
+ */
+extern bool checkpointLoad (void);
+
+/**
+ *  \brief Check if a checkpoint is due, CKPTPERIOD seconds after the last one of the caller.
+ *
+ *  \param last time of the last checkpoint of the caller, updated if one is due (0 to start counting)
+ *
+ *  \return true if a checkpoint is due
+ */
+extern bool checkpointDue (double *last);
+
+/**
+ *  \brief Record the progress of a file.
+ *
+ *  \param fileID file identification
+ *  \param state CKPT_PARTIAL or CKPT_DONE
+ *  \param offset number of bytes of the file already counted
+ *  \param res results of those bytes
+ *  \param chunk last chunk counted (NULL if no context is kept)
+ */
+extern void checkpointFile (int fileID, int state, off_t offset, TempResults *res, Chunk *chunk);
+
+/**
+ *  \brief Get the progress of a file recorded by the checkpoint being resumed.
+ *
+ *  \param fileID file identification
+ *  \param offset returns the number of bytes of the file already counted
+ *  \param res returns the results of those bytes (the occurrences of the patterns are copied to the array of the
+ *         caller, if any)
+ *  \param chunk returns the end of the last chunk counted, to be kept in front of the next one
+ *
+ *  \return state of the file: CKPT_PENDING, CKPT_PARTIAL or CKPT_DONE
+ */
+extern int checkpointRestore (int fileID, off_t *offset, TempResults *res, Chunk *chunk);
+
+/**
+ *  \brief Write a checkpoint with the progress recorded so far.
+ *
+ *  The checkpoint file is replaced whole, so a failed checkpoint leaves the last one.
+ *
+ *  \param force flag signaling the checkpoint must be written even if the last one is recent
+ */
+extern void checkpointWrite (bool force);
+
+#endif /* CHECKPOINT_H */
@@ -0,0 +1,445 @@
+/**
+ *  \file chunkIndex.c (implementation file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Sidecar index of a file (stored as <file>.idx) with the summary of every chunk, used to answer the counts of a
+ *  byte or line range without scanning the whole range.
+ *
+ *  Index layout (integers little-endian):
+ *     \li magic "CLX4", the normalization flag and the number of chunks, as 32 bit integers, and the size and
+ *         modification time of the file (seconds and nanoseconds), as 64 bit integers
+ *     \li for each chunk, its offset, as a 64 bit integer, its size and number of lines, as 32 bit integers, and
+ *         its nine counters (words, A, E, I, O, U, C, Y and invalid sequences), as 64 bit integers.
+ *
+ *  An index whose header does not match the file or the current options is ignored.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "probConst.h"
+#include "dataStructures.h"
+#include "countWords.h"
+#include "chunkReader.h"
+#include "utf8.h"
+#include "chunkIndex.h"
+#include "binFile.h"
+#include "utils.h"
+
+/** \brief flag signaling decomposed diacritics must be composed before counting */
+extern bool normalizeNFC;
+
+/** \brief index file identification */
+static const char magic[4] = { 'C', 'L', 'X', '4' };
+
+/**
+ *  \brief Get the name of the sidecar file of a file.
+ *
+ *  Internal operation.
+ *
+ *  \param fileName name of the indexed file
+ *
+ *  \return name of the sidecar file (allocated)
+ */
+
+static char *indexName (const char *fileName)
+{
+  char *name;
+
+  if ((name = malloc (strlen (fileName) + 5)) == NULL)
+     { fprintf (stderr, "error on allocating space to the index name\n");
+       exit (EXIT_FAILURE);
+     }
+  sprintf (name, "%s.idx", fileName);
+  return name;
+}
+
+/**
+ *  \brief Add the results of a chunk to a total.
+ *
+ *  Internal operation.
+ *
+ *  \param total total results
+ *  \param res results to add
+ */
+
+static void addResults (TempResults *total, TempResults *res)
+{
+  total->nWords += res->nWords;
+  total->a += res->a;
+  total->e += res->e;
+  total->i += res->i;
+  total->o += res->o;
+  total->u += res->u;
+  total->c += res->c;
+  total->y += res->y;
+  total->nInvalid += res->nInvalid;
+}
+
+/**
+ *  \brief Count a byte range of an open file by scanning it.
+ *
+ *  Internal operation.
+ *
+ *  \param fp file
+ *  \param start first byte of the range
+ *  \param end byte after the range
+ *  \param total results, to which the counts of the range are added
+ */
+
+static void scanRange (FILE *fp, off_t start, off_t end, TempResults *total)
+{
+  Chunk *chunk;
+  TempResults res;
+  bool endF = false;
+
+  if (start >= end) return;
+  if ((chunk = malloc (sizeof (Chunk))) == NULL)
+     { fprintf (stderr, "error on allocating space to the data chunk\n");
+       exit (EXIT_FAILURE);
+     }
+  fseeko (fp, start, SEEK_SET);
+  chunk->numBytes = 0;
+  res.patternCounts = NULL;
+  while (!endF)
+  { off_t offset = ftello (fp);
+    endF = readChunk (fp, chunk);
+    if (offset + chunk->numBytes >= end)                                         /* the range ends in this chunk */
+       { chunk->numBytes = (int) (end - offset);
+         endF = true;
+       }
+    count (chunk, &res);
+    addResults (total, &res);
+  }
+  free (chunk);
+}
+
+/**
+ *  \brief Get the offset of the start of a line of an open file.
+ *
+ *  Internal operation.
+ *
+ *  \param fp file
+ *  \param idx index of the file, or NULL to scan it from the beginning
+ *  \param fileBytes size of the file
+ *  \param line line number, starting at 1
+ *
+ *  \return offset of the first byte of the line, or the size of the file if it has less lines
+ */
+
+static off_t lineOffset (FILE *fp, ChunkIndex *idx, off_t fileBytes, off_t line)
+{
+  off_t needed = line - 1;                                                 /* newlines before the line starts */
+  off_t offset = 0;                                                                 /* where the scan starts */
+  off_t limit = fileBytes;                                                            /* where the scan stops */
+  int c;
+
+  if (needed <= 0) return 0;
+  if (idx != NULL)                                                       /* skip the chunks before the line */
+     { int k;
+       for (k = 0; (k < idx->nEntries) && (needed > idx->entries[k].nLines); k++)
+         needed -= idx->entries[k].nLines;
+       if (k == idx->nEntries) return fileBytes;
+       offset = idx->entries[k].offset;
+       limit = offset + idx->entries[k].numBytes;
+     }
+  fseeko (fp, offset, SEEK_SET);
+  for (; (offset < limit) && ((c = getc (fp)) != EOF); offset++)
+    if ((c == '\n') && (--needed == 0)) return offset + 1;
+  return fileBytes;
+}
+
+/**
+ *  \brief Parse a range: bytes:start-end (end excluded) or lines:first-last (both included).
+ *
+ *  The end may be omitted to reach the end of the file.
+ *
+ *  \param spec string to parse
+ *  \param range returns the range
+ *
+ *  \return true if the range is valid
+ */
+
+bool parseRange (const char *spec, Range *range)
+{
+  const char *p;
+  char *end;
+
+  if (strncmp (spec, "bytes:", 6) == 0) range->kind = RANGE_BYTES;
+  else if (strncmp (spec, "lines:", 6) == 0) range->kind = RANGE_LINES;
+  else return false;
+  p = spec + 6;
+  range->start = (off_t) strtoll (p, &end, 10);
+  if ((end == p) || (*end != '-') || (range->start < 0)) return false;
+  p = end + 1;
+  if (*p == '\0') range->end = -1;
+  else { range->end = (off_t) strtoll (p, &end, 10);
+         if ((*end != '\0') || (range->end < range->start)) return false;
+       }
+  if ((range->kind == RANGE_LINES) && (range->start < 1)) return false;
+  return true;
+}
+
+/**
+ *  \brief Initialize an empty index.
+ *
+ *  \param idx index
+ */
+
+void indexInit (ChunkIndex *idx)
+{
+  memset (idx, 0, sizeof (ChunkIndex));
+}
+
+/**
+ *  \brief Add the summary of the next chunk of the file to an index.
+ *
+ *  \param idx index
+ *  \param offset offset of the chunk in the file
+ *  \param chunk chunk
+ *  \param res results of the chunk
+ */
+
+void indexAdd (ChunkIndex *idx, off_t offset, Chunk *chunk, TempResults *res)
+{
+  if (idx->nEntries == idx->capacity)
+     { int capacity = (idx->capacity == 0) ? 256 : 2 * idx->capacity;
+       IndexEntry *entries;
+       if ((entries = realloc (idx->entries, capacity * sizeof (IndexEntry))) == NULL)
+          { fprintf (stderr, "error on allocating space to the chunk index\n");
+            exit (EXIT_FAILURE);
+          }
+       idx->entries = entries;
+       idx->capacity = capacity;
+     }
+
+  IndexEntry *entry = &idx->entries[idx->nEntries];
+  entry->offset = offset;
+  entry->numBytes = chunk->numBytes - chunk->overlap;
+  entry->nLines = 0;
+  for (int p = chunk->overlap; p < chunk->numBytes; p++)
+    if (chunk->textChunk[p] == '\n') entry->nLines += 1;
+  entry->res = *res;
+  entry->res.patternCounts = NULL;
+  idx->nEntries += 1;
+}
+
+/**
+ *  \brief Write the summary of a chunk.
+ *
+ *  Internal operation.
+ *
+ *  \param fp stream to write to
+ *  \param entry summary of the chunk
+ *
+ *  \return true on success
+ */
+
+static bool putEntry (FILE *fp, IndexEntry *entry)
+{
+  return putInt64 (fp, entry->offset) && putInt32 (fp, entry->numBytes) && putInt32 (fp, entry->nLines) &&
+         putInt64 (fp, entry->res.nWords) && putInt64 (fp, entry->res.a) && putInt64 (fp, entry->res.e) &&
+         putInt64 (fp, entry->res.i) && putInt64 (fp, entry->res.o) && putInt64 (fp, entry->res.u) &&
+         putInt64 (fp, entry->res.c) && putInt64 (fp, entry->res.y) && putInt64 (fp, entry->res.nInvalid);
+}
+
+/**
+ *  \brief Read the summary of a chunk.
+ *
+ *  Internal operation.
+ *
+ *  \param fp stream to read from
+ *  \param entry returns the summary of the chunk
+ *
+ *  \return true on success, false on a truncated index
+ */
+
+static bool getEntry (FILE *fp, IndexEntry *entry)
+{
+  long long offset;
+
+  memset (entry, 0, sizeof (IndexEntry));
+  if (!getInt64 (fp, &offset) || !getInt32 (fp, &entry->numBytes) || !getInt32 (fp, &entry->nLines) ||
+      !getInt64 (fp, &entry->res.nWords) || !getInt64 (fp, &entry->res.a) || !getInt64 (fp, &entry->res.e) ||
+      !getInt64 (fp, &entry->res.i) || !getInt64 (fp, &entry->res.o) || !getInt64 (fp, &entry->res.u) ||
+      !getInt64 (fp, &entry->res.c) || !getInt64 (fp, &entry->res.y) || !getInt64 (fp, &entry->res.nInvalid))
+     return false;
+  entry->offset = (off_t) offset;
+  return true;
+}
+
+/**
+ * \brief Struct to store an index and the version of the indexed file, while they are written
+ */
+typedef struct
+{
+    ChunkIndex *idx;
+    struct stat st;
+} IndexContents;
+
+/**
+ *  \brief Write an index, as the contents of its sidecar file.
+ *
+ *  Internal operation.
+ *
+ *  \param fp stream to write to
+ *  \param arg index and version of the indexed file, as an IndexContents
+ *
+ *  \return true on success
+ */
+
+static bool putIndex (FILE *fp, void *arg)
+{
+  IndexContents *ic = arg;
+  bool ok;
+
+  ok = (fwrite (magic, sizeof (magic), 1, fp) == 1) && putInt32 (fp, normalizeNFC) &&
+       putInt32 (fp, ic->idx->nEntries) && putInt64 (fp, ic->st.st_size) && putInt64 (fp, ic->st.st_mtim.tv_sec) &&
+       putInt64 (fp, ic->st.st_mtim.tv_nsec);
+  for (int k = 0; ok && (k < ic->idx->nEntries); k++)
+    ok = putEntry (fp, &ic->idx->entries[k]);
+
+  return ok;
+}
+
+/**
+ *  \brief Store the index of a file in its sidecar file.
+ *
+ *  The sidecar file is replaced whole, so an interrupted run leaves no truncated index.
+ *
+ *  \param idx index
+ *  \param fileName name of the indexed file
+ */
+
+void indexWrite (ChunkIndex *idx, const char *fileName)
+{
+  char *name = indexName (fileName);
+  IndexContents ic;
+
+  ic.idx = idx;
+  if (stat (fileName, &ic.st) != 0)
+     { perror (fileName);
+       free (name);
+       return;
+     }
+  if (!replaceFile (name, putIndex, &ic)) perror (name);
+  free (name);
+}
+
+/**
+ *  \brief Load the index of a file from its sidecar file.
+ *
+ *  \param idx index
+ *  \param fileName name of the indexed file
+ *
+ *  \return true if the index exists and is up to date with the file
+ */
+
+bool indexRead (ChunkIndex *idx, const char *fileName)
+{
+  char *name = indexName (fileName);
+  char id[4];
+  int32_t nfc, nEntries;
+  long long fileBytes, mtime, mtimeNsec;
+  struct stat st;
+  FILE *fp;
+  bool valid = false;
+
+  indexInit (idx);
+  if ((stat (fileName, &st) == 0) && ((fp = fopen (name, "rb")) != NULL))
+     { if ((fread (id, sizeof (id), 1, fp) == 1) && (memcmp (id, magic, sizeof (magic)) == 0) &&
+           getInt32 (fp, &nfc) && getInt32 (fp, &nEntries) && getInt64 (fp, &fileBytes) && getInt64 (fp, &mtime) &&
+           getInt64 (fp, &mtimeNsec) && (nfc == normalizeNFC) && (nEntries >= 0) && (fileBytes == st.st_size) &&
+           (mtime == st.st_mtim.tv_sec) && (mtimeNsec == st.st_mtim.tv_nsec) &&
+           ((idx->entries = malloc ((nEntries + 1) * sizeof (IndexEntry))) != NULL))
+          { int k = 0;
+            while ((k < nEntries) && getEntry (fp, &idx->entries[k]))
+              k++;
+            if (k == nEntries)
+               { idx->nEntries = idx->capacity = nEntries;
+                 idx->fileBytes = fileBytes;
+                 idx->mtime = mtime;
+                 idx->mtimeNsec = mtimeNsec;
+                 valid = true;
+               }
+          }
+       fclose (fp);
+     }
+  if (!valid) indexFree (idx);
+  free (name);
+  return valid;
+}
+
+/**
+ *  \brief Release the memory of an index.
+ *
+ *  \param idx index
+ */
+
+void indexFree (ChunkIndex *idx)
+{
+  free (idx->entries);
+  indexInit (idx);
+}
+
+/**
+ *  \brief Count the words of a range of a file, as if the range were a file of its own.
+ *
+ *  The index of the file is used when it is up to date; otherwise the whole range is scanned.
+ *
+ *  \param fileName name of the file
+ *  \param range range to count
+ *  \param res returns the results of the range
+ *  \param indexed returns whether the index was used
+ *
+ *  \return true if the file could be read
+ */
+
+bool countRange (const char *fileName, Range *range, TempResults *res, bool *indexed)
+{
+  ChunkIndex idx;
+  struct stat st;
+  FILE *fp;
+  off_t start, end;
+
+  memset (res, 0, sizeof (TempResults));
+  if ((stat (fileName, &st) != 0) || ((fp = fopen (fileName, "rb")) == NULL))
+     return false;
+  *indexed = indexRead (&idx, fileName);
+
+  if (range->kind == RANGE_LINES)
+     { start = lineOffset (fp, *indexed ? &idx : NULL, st.st_size, range->start);
+       end = (range->end < 0) ? st.st_size : lineOffset (fp, *indexed ? &idx : NULL, st.st_size, range->end + 1);
+     }
+  else { start = (range->start < st.st_size) ? range->start : st.st_size;
+         end = ((range->end < 0) || (range->end > st.st_size)) ? st.st_size : range->end;
+       }
+
+  int first = 0, last = -1;                                           /* chunks fully inside the range */
+  if (*indexed)
+     { while ((first < idx.nEntries) && (idx.entries[first].offset < start))
+         first++;
+       last = first - 1;
+       while ((last + 1 < idx.nEntries) && (idx.entries[last + 1].offset + idx.entries[last + 1].numBytes <= end))
+         last++;
+     }
+  if (first <= last)
+     { scanRange (fp, start, idx.entries[first].offset, res);                                  /* leading piece */
+       for (int k = first; k <= last; k++)
+         addResults (res, &idx.entries[k].res);
+       scanRange (fp, idx.entries[last].offset + idx.entries[last].numBytes, end, res);      /* trailing piece */
+     }
+  else scanRange (fp, start, end, res);
+
+  indexFree (&idx);
+  fclose (fp);
+  return true;
+}
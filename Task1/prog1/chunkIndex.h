@@ -0,0 +1,130 @@
+/**
+ *  \file chunkIndex.h (interface file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Sidecar index of a file (stored as <file>.idx) with the summary of every chunk, used to answer the counts of a
+ *  byte or line range without scanning the whole range.
+ *
+ *  Since chunks end at word boundaries, the counts of a range are the sum of the summaries of the chunks fully
+ *  inside it plus the counts of the two partial pieces at its edges, which are the only bytes read.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#ifndef CHUNKINDEX_H
+#define CHUNKINDEX_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+#include "dataStructures.h"
+
+/** \brief range given in bytes, starting at 0 */
+#define RANGE_BYTES    0
+
+/** \brief range given in lines, starting at 1 */
+#define RANGE_LINES    1
+
+/**
+ * \brief Struct to store the summary of a chunk
+ */
+typedef struct
+{
+    off_t offset;
+    int numBytes;
+    int nLines;
+    TempResults res;
+} IndexEntry;
+
+/**
+ * \brief Struct to store the index of a file
+ */
+typedef struct
+{
+    off_t fileBytes;
+    long long mtime;
+    long mtimeNsec;
+    int nEntries;
+    int capacity;
+    IndexEntry *entries;
+} ChunkIndex;
+
+/**
+ * \brief Struct to store a range query
+ */
+typedef struct
+{
+    int kind;
+    off_t start;
+    off_t end;
+} Range;
+
+/**
+ *  \brief Parse a range: bytes:start-end (end excluded) or lines:first-last (both included).
+ *
+ *  The end may be omitted to reach the end of the file.
+ *
+ *  \param spec string to parse
+ *  \param range returns the range
+ *
+ *  \return true if the range is valid
+ */
+extern bool parseRange (const char *spec, Range *range);
+
+/**
+ *  \brief Initialize an empty index.
+ *
+ *  \param idx index
+ */
+extern void indexInit (ChunkIndex *idx);
+
+/**
+ *  \brief Add the summary of the next chunk of the file to an index.
+ *
+ *  \param idx index
+ *  \param offset offset of the chunk in the file
+ *  \param chunk chunk
+ *  \param res results of the chunk
+ */
+extern void indexAdd (ChunkIndex *idx, off_t offset, Chunk *chunk, TempResults *res);
+
+/**
+ *  \brief Store the index of a file in its sidecar file.
+ *
+ *  \param idx index
+ *  \param fileName name of the indexed file
+ */
+extern void indexWrite (ChunkIndex *idx, const char *fileName);
+
+/**
+ *  \brief Load the index of a file from its sidecar file.
+ *
+ *  \param idx index
+ *  \param fileName name of the indexed file
+ *
+ *  \return true if the index exists and is up to date with the file
+ */
+extern bool indexRead (ChunkIndex *idx, const char *fileName);
+
+/**
+ *  \brief Release the memory of an index.
+ *
+ *  \param idx index
+ */
+extern void indexFree (ChunkIndex *idx);
+
+/**
+ *  \brief Count the words of a range of a file, as if the range were a file of its own.
+ *
+ *  The index of the file is used when it is up to date; otherwise the whole range is scanned.
+ *
+ *  \param fileName name of the file
+ *  \param range range to count
+ *  \param res returns the results of the range
+ *  \param indexed returns whether the index was used
+ *
+ *  \return true if the file could be read
+ */
+extern bool countRange (const char *fileName, Range *range, TempResults *res, bool *indexed);
+
+#endif /* CHUNKINDEX_H */
@@ -0,0 +1,307 @@
+/**
+ *  \file chunkReader.c (implementation file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Splitting of a text file in chunks which end at a word boundary.
+ *
+ *  The word boundaries are found with the same character classification used by the workers, so that every
+ *  chunk can be counted independently. To find them the bytes are classified through tables instead of being
+ *  decoded: only the sequences which may stand for a separator or an apostrophe, and the malformed ones, go through
+ *  the decoder.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+#include "probConst.h"
+#include "dataStructures.h"
+#include "countWords.h"
+#include "utf8.h"
+#include "chunkReader.h"
+
+/** \brief number of bytes of the previous chunk to be kept in front of each chunk */
+static int context = 0;
+
+/** \brief class of each byte on its own: an ASCII character, or a byte outside a well-formed UTF-8 sequence */
+static signed char byteClass[256];
+
+/** \brief flag signaling some character encoded with a given lead byte is not a letter */
+static bool notOnlyLetters[256];
+
+/** \brief flag which warrants that the tables of classes are built exactly once */
+static pthread_once_t tablesInit = PTHREAD_ONCE_INIT;
+
+/**
+ *  \brief Build the tables of classes from the character classification of the workers.
+ *
+ *  Internal operation.
+ */
+
+static void buildTables (void)
+{
+  for (int b = 0; b < 256; b++)
+  { unsigned char byte = (unsigned char) b;
+    int pos = 0;
+    bool invalid;
+    byteClass[b] = (signed char) charClass (utf8Decode (&byte, 1, &pos, &invalid));
+  }
+  for (int cp = 0x80; cp <= 0x10FFFF; cp++)                                       /* lead byte of each character */
+    if (charClass (cp) != LETTER)
+       { int lead = (cp < 0x800) ? 0xC0 | (cp >> 6) : (cp < 0x10000) ? 0xE0 | (cp >> 12) : 0xF0 | (cp >> 18);
+         notOnlyLetters[lead] = true;
+       }
+}
+
+/**
+ *  \brief Get the class of a UTF-8 sequence from its bytes, without decoding it.
+ *
+ *  Internal operation.
+ *
+ *  \param seq bytes of the sequence (a lead byte and the continuation bytes which follow it)
+ *  \param len number of bytes of the sequence
+ *
+ *  \return SEPARATOR, LETTER or JOINER, or -1 if the sequence must be decoded
+ */
+
+static int seqClass (const unsigned char *seq, int len)
+{
+  unsigned char lead = seq[0];
+
+  if (len == 1) return byteClass[lead];
+  if ((len != utf8SeqLen (lead)) || notOnlyLetters[lead]) return -1;
+  if (((lead == 0xE0) && (seq[1] < 0xA0)) || ((lead == 0xED) && (seq[1] > 0x9F)) ||      /* overlong or surrogate */
+      ((lead == 0xF0) && (seq[1] < 0x90)) || ((lead == 0xF4) && (seq[1] > 0x8F)))         /* overlong or too big */
+     return -1;
+  return LETTER;
+}
+
+/**
+ *  \brief Set the number of bytes of the previous chunk to be kept in front of each chunk.
+ *
+ *  \param nBytes number of bytes of context
+ */
+
+void setChunkContext (int nBytes)
+{
+  context = nBytes;
+}
+
+/**
+ *  \brief Start a new chunk, keeping the end of the previous one in front of it if some context is required.
+ *
+ *  The context starts at a separator, so the words in it are whole, unless the previous chunk ends with a word
+ *  too long for it to hold one.
+ *
+ *  Internal operation.
+ *
+ *  \param chunk chunk holding the previous chunk, or empty
+ */
+
+static void keepContext (Chunk *chunk)
+{
+  unsigned char *buf = chunk->textChunk;
+  int b = 0;                                                                               /* bytes in the chunk */
+
+  if ((context > 0) && (chunk->numBytes > 0))                       /* keep the end of the previous chunk */
+     { int from = (chunk->numBytes > context) ? chunk->numBytes - context : 0;
+       int sep = -1, pos;
+       bool invalid;
+       while ((from < chunk->numBytes) && ((buf[from] & 0xC0) == 0x80))        /* start at a whole character */
+         from++;
+       for (pos = from; (sep == -1) && (pos < chunk->numBytes); )                  /* and at a separator, if any */
+       { int at = pos;
+         if (charClass (utf8Decode (buf, chunk->numBytes, &pos, &invalid)) == SEPARATOR) sep = at;
+       }
+       if (sep != -1) from = sep;
+       b = chunk->numBytes - from;
+       memmove (buf, buf + from, b);
+     }
+  chunk->numBytes = chunk->overlap = b;
+}
+
+/**
+ *  \brief Append a UTF-8 sequence (or the bytes of a malformed one) to a chunk being filled.
+ *
+ *  Internal operation.
+ *
+ *  \param chunk chunk being filled
+ *  \param inWord flag signaling the chunk ends inside a word, updated
+ *  \param seq bytes of the sequence
+ *  \param len number of bytes of the sequence
+ *
+ *  \return true if the chunk is complete
+ */
+
+static bool addSequence (Chunk *chunk, bool *inWord, const unsigned char *seq, int len)
+{
+  unsigned char *buf = chunk->textChunk;
+  int start = chunk->numBytes;                                                     /* first byte of the sequence */
+  int b = start + len;                                                                     /* bytes in the chunk */
+  bool pastInWord = *inWord;
+  bool invalid;
+  int pos = start;
+  int cls = seqClass (seq, len);
+
+  memcpy (buf + start, seq, len);
+  if (cls == SEPARATOR) *inWord = false;
+  else if (cls == LETTER) *inWord = true;
+  else if (cls < 0)
+          while (pos < b)                            /* an invalid sequence stands for one character per byte */
+          { cls = charClass (utf8Decode (buf, b, &pos, &invalid));
+            if (cls == SEPARATOR) *inWord = false;
+            else if (cls == LETTER) *inWord = true;
+          }
+  chunk->numBytes = b;
+
+  return (pastInWord && !*inWord && (b - chunk->overlap >= CHUNKSIZE)) ||
+         (b > MAXCHUNK - 4);                                     /* a word too long for a chunk is split */
+}
+
+/**
+ *  \brief Read the next chunk of a file.
+ *
+ *  The chunk is closed at the first word boundary after CHUNKSIZE bytes, and never splits a UTF-8 sequence.
+ *
+ *  When some context is required, the last bytes of the previous chunk are kept in front of the new one (its
+ *  overlap), so the chunk must be emptied (numBytes set to 0) before the first chunk of each file.
+ *
+ *  \param fp file to read from
+ *  \param chunk chunk to fill (the file id is left untouched)
+ *
+ *  \return true if the end of file was reached
+ */
+
+bool readChunk (FILE *fp, Chunk *chunk)
+{
+  unsigned char seq[4];                                                             /* bytes of a UTF-8 sequence */
+  bool inWord = false;
+  int display;
+
+  pthread_once (&tablesInit, buildTables);
+  keepContext (chunk);
+  while ((display = fgetc (fp)) != EOF)
+  { int len = utf8SeqLen (display);
+    int k = 0;
+
+    seq[k++] = (unsigned char) display;
+    while (k < len)                                                                      /* continuation bytes */
+    { if ((display = fgetc (fp)) == EOF) break;
+      if ((display & 0xC0) != 0x80)                                            /* truncated sequence */
+         { ungetc (display, fp);
+           break;
+         }
+      seq[k++] = (unsigned char) display;
+    }
+    if (addSequence (chunk, &inWord, seq, k)) return false;
+  }
+  return true;
+}
+
+/**
+ *  \brief Move to the first word boundary at or after an offset of a file.
+ *
+ *  The file is read up to the first separator at or after the offset; the rest of a character cut by the offset is
+ *  skipped. A chunk read from there starts at an arbitrary word boundary, not in general at one where readChunk
+ *  would start a chunk if the file were read from its start.
+ *
+ *  \param fp file to read from
+ *  \param offset offset to start looking at
+ *
+ *  \return true if the end of file was reached before a word boundary
+ */
+
+bool seekChunk (FILE *fp, off_t offset)
+{
+  unsigned char seq[4];                                                             /* bytes of a UTF-8 sequence */
+  int display;
+
+  if (fseeko (fp, offset, SEEK_SET) != 0) return true;
+  if (offset == 0) return false;                                           /* the start of the file is a boundary */
+  while ((display = fgetc (fp)) != EOF)
+  { int len = utf8SeqLen (display);
+    int k = 0, pos = 0;
+    bool invalid;
+
+    if ((display & 0xC0) == 0x80) continue;                           /* the rest of a character cut by the offset */
+    seq[k++] = (unsigned char) display;
+    while (k < len)                                                                      /* continuation bytes */
+    { if ((display = fgetc (fp)) == EOF) break;
+      if ((display & 0xC0) != 0x80)                                            /* truncated sequence */
+         { ungetc (display, fp);
+           break;
+         }
+      seq[k++] = (unsigned char) display;
+    }
+    if (charClass (utf8Decode (seq, k, &pos, &invalid)) == SEPARATOR) return false;
+  }
+  return true;
+}
+
+/**
+ *  \brief Start splitting a file fed in blocks.
+ *
+ *  \param s splitter
+ *  \param fileID file identification
+ */
+
+void splitterInit (Splitter *s, int fileID)
+{
+  s->chunk.fileID = fileID;
+  s->chunk.numBytes = s->chunk.overlap = 0;
+  s->inWord = false;
+  s->full = false;
+  s->nPending = 0;
+}
+
+/**
+ *  \brief Feed a block of a file to a splitter, until a chunk is complete or the block is exhausted.
+ *
+ *  The chunks are exactly those readChunk would read from the whole file. A UTF-8 sequence cut by the end of a
+ *  block is completed with the first bytes of the next one.
+ *
+ *  \param s splitter
+ *  \param in bytes of the block
+ *  \param n number of bytes of the block
+ *  \param pos position in the block, advanced past the bytes consumed
+ *  \param last flag signaling the block is the last one of the file
+ *
+ *  \return true if a chunk is complete (in s->chunk); false if the block is exhausted, in which case s->chunk holds
+ *          the last chunk of the file, if the block was the last one and the chunk has bytes of its own
+ */
+
+bool splitterNext (Splitter *s, const unsigned char *in, int n, int *pos, bool last)
+{
+  pthread_once (&tablesInit, buildTables);
+  if (s->full)                                                           /* the previous chunk was handed out */
+     { keepContext (&s->chunk);
+       s->inWord = false;
+       s->full = false;
+     }
+  for (;;)
+  { unsigned char *seq = s->pending;
+    int k = s->nPending;
+
+    if (k == 0)
+       { if (*pos >= n) return false;
+         seq[k++] = in[(*pos)++];
+       }
+    int len = utf8SeqLen (seq[0]);
+    while ((k < len) && (*pos < n) && ((in[*pos] & 0xC0) == 0x80))                     /* continuation bytes */
+      seq[k++] = in[(*pos)++];
+    if ((k < len) && (*pos == n) && !last)                    /* the sequence goes on in the next block */
+       { s->nPending = k;
+         return false;
+       }
+    s->nPending = 0;
+    if (addSequence (&s->chunk, &s->inWord, seq, k))
+       { s->full = true;
+         return true;
+       }
+  }
+}
@@ -0,0 +1,92 @@
+/**
+ *  \file chunkReader.h (interface file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Splitting of a text file in chunks which end at a word boundary.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#ifndef CHUNKREADER_H
+#define CHUNKREADER_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <sys/types.h>
+#include "dataStructures.h"
+
+/**
+ * \brief Struct to store the state of the splitting of a file fed in blocks
+ */
+typedef struct
+{
+    Chunk chunk;
+    bool inWord;
+    bool full;
+    int nPending;
+    unsigned char pending[4];
+} Splitter;
+
+/**
+ *  \brief Read the next chunk of a file.
+ *
+ *  The chunk is closed at the first word boundary after CHUNKSIZE bytes, and never splits a UTF-8 sequence.
+ *
+ *  When some context is required, the last bytes of the previous chunk are kept in front of the new one (its
+ *  overlap), so the chunk must be emptied (numBytes set to 0) before the first chunk of each file.
+ *
+ *  \param fp file to read from
+ *  \param chunk chunk to fill (the file id is left untouched)
+ *
+ *  \return true if the end of file was reached
+ */
+extern bool readChunk (FILE *fp, Chunk *chunk);
+
+/**
+ *  \brief Move to the first word boundary at or after an offset of a file.
+ *
+ *  The file is read up to the first separator at or after the offset; the rest of a character cut by the offset is
+ *  skipped. A chunk read from there starts at an arbitrary word boundary, not in general at one where readChunk
+ *  would start a chunk if the file were read from its start.
+ *
+ *  \param fp file to read from
+ *  \param offset offset to start looking at
+ *
+ *  \return true if the end of file was reached before a word boundary
+ */
+extern bool seekChunk (FILE *fp, off_t offset);
+
+/**
+ *  \brief Set the number of bytes of the previous chunk to be kept in front of each chunk.
+ *
+ *  \param nBytes number of bytes of context
+ */
+extern void setChunkContext (int nBytes);
+
+/**
+ *  \brief Start splitting a file fed in blocks.
+ *
+ *  \param s splitter
+ *  \param fileID file identification
+ */
+extern void splitterInit (Splitter *s, int fileID);
+
+/**
+ *  \brief Feed a block of a file to a splitter, until a chunk is complete or the block is exhausted.
+ *
+ *  The chunks are exactly those readChunk would read from the whole file. A UTF-8 sequence cut by the end of a
+ *  block is completed with the first bytes of the next one.
+ *
+ *  \param s splitter
+ *  \param in bytes of the block
+ *  \param n number of bytes of the block
+ *  \param pos position in the block, advanced past the bytes consumed
+ *  \param last flag signaling the block is the last one of the file
+ *
+ *  \return true if a chunk is complete (in s->chunk); false if the block is exhausted, in which case s->chunk holds
+ *          the last chunk of the file, if the block was the last one and the chunk has bytes of its own
+ */
+extern bool splitterNext (Splitter *s, const unsigned char *in, int n, int *pos, bool last);
+
+#endif /* CHUNKREADER_H */
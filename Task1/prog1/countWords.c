@@ -3,6 +3,8 @@
  *  \brief Problem name: Text processing in Portuguese
  *  Counts the number of words and words with A, E, I, O, U, Y and Ç
  *
+ *  The chunk is first decoded (and optionally normalized) into code points by the utf8 module, so that the
+ *  classification only deals with whole characters.
  *
  *  \author João Morais and Miguel Ferreira
  */
@@ -11,7 +13,90 @@
 #include <stdbool.h>
 #include "dataStructures.h"
 #include "countWords.h"
+#include "utf8.h"
+#include "patterns.h"
 
+/** \brief flag signaling decomposed diacritics must be composed before counting */
+extern bool normalizeNFC;
+
+/** \brief bit of each letter in a vowel mask */
+enum { A_BIT = 1, E_BIT = 2, I_BIT = 4, O_BIT = 8, U_BIT = 16, C_BIT = 32, Y_BIT = 64 };
+
+/**
+ *  \brief Get the letters of interest a code point stands for
+ *
+ *  \param cp code point
+ *
+ *  \return vowel mask
+ */
+static int vowelMask(int cp)
+{
+    switch (cp)
+    {
+        case 'a': case 'A': case 0xC0: case 0xC1: case 0xC2: case 0xC3: case 0xE0: case 0xE1: case 0xE2: case 0xE3:
+            return A_BIT;
+        case 'e': case 'E': case 0xC8: case 0xC9: case 0xCA: case 0xE8: case 0xE9: case 0xEA:
+            return E_BIT;
+        case 'i': case 'I': case 0xCC: case 0xCD: case 0xEC: case 0xED:
+            return I_BIT;
+        case 'o': case 'O': case 0xD2: case 0xD3: case 0xD4: case 0xD5: case 0xF2: case 0xF3: case 0xF4: case 0xF5:
+            return O_BIT;
+        case 'u': case 'U': case 0xD9: case 0xDA: case 0xF9: case 0xFA:
+            return U_BIT;
+        case 0xC7: case 0xE7:
+            return C_BIT;
+        case 'y': case 'Y':
+            return Y_BIT;
+        default:
+            return 0;
+    }
+}
+
+/**
+ *  \brief Classifies a code point for the word splitting rules
+ *
+ *  \param cp code point
+ *
+ *  \return SEPARATOR, LETTER or JOINER
+ */
+int charClass(int cp)
+{
+    switch (cp)
+    {
+        case ' ': case '\t': case '\n': case '\r':                                              /* white space */
+        case '.': case ',': case ':': case ';': case '?': case '!':                             /* punctuation */
+        case '-': case 0x2013: case 0x2014: case 0x2026:                             /* dash and ellipsis */
+        case '(': case ')': case '[': case ']':                                                    /* brackets */
+        case '"': case 0x201C: case 0x201D: case 0xAB: case 0xBB:                                /* quotation */
+        case 0xA0:                                                                           /* no-break space */
+            return SEPARATOR;
+        case '\'': case 0x2018: case 0x2019:                                                     /* apostrophe */
+            return JOINER;
+        default:
+            return LETTER;
+    }
+}
+
+/**
+ *  \brief Decodes a chunk into code points, validating it
+ *
+ *  \param in chunk of data
+ *  \param out decoded chunk
+ *  \param withContext flag signaling the context repeated from the previous chunk must be decoded as well
+ */
+void decode(Chunk *in, DecodedChunk *out, bool withContext)
+{
+    int nInvalid;
+
+    out->fileID = in->fileID;
+    out->index = in->index;
+    out->numBytes = in->numBytes;
+    out->ownStart = 0;
+    if( withContext && in->overlap > 0 ) /* context repeated from the previous chunk */
+        out->ownStart = decodeChunk(in->textChunk, in->overlap, out->cps, normalizeNFC, &nInvalid);
+    out->n = out->ownStart + decodeChunk(in->textChunk + in->overlap, in->numBytes - in->overlap,
+                                         out->cps + out->ownStart, normalizeNFC, &out->nInvalid);
+}
 
 /**
  *  \brief Counts the number of words and words with A, E, I, O, U, Y and Ç
@@ -21,132 +106,63 @@
  */
 void count(Chunk *in, TempResults *out)
 {
-    int display;
+    DecodedChunk decoded;
+
+    decode(in, &decoded, out->patternCounts != NULL);
+    countDecoded(&decoded, out);
+}
+
+/**
+ *  \brief Counts the number of words and words with A, E, I, O, U, Y and Ç of a decoded chunk
+ *
+ *  \param in decoded chunk
+ *  \param out partial results of this chunk
+ */
+void countDecoded(DecodedChunk *in, TempResults *out)
+{
+    const int *cps = in->cps;
+    int k = in->ownStart; /* first code point of the chunk proper */
+    int n = in->n;
 
     int a = 0;
-    bool aFlag = true;
     int e = 0;
-    bool eFlag = true;
     int i = 0;
-    bool iFlag = true;
     int o = 0;
-    bool oFlag = true;
     int u = 0;
-    bool uFlag = true;
     int c = 0;
-    bool cFlag = true;
     int y = 0;
-    bool yFlag = true;
     int w = 0;
-    bool go = false;
-    int prev = 0;
-    int newWord[] = {166,147,157,156,32,46,44,58,59,45,63,33,34,40,41,91,9,10,13,194,187,171};
-    int arrLen = sizeof newWord / sizeof newWord[0];
+    int found = 0;                                        /* letters of interest already found in this word */
     bool inWord = false;
 
-    for(int p = 0 ; p < in->numBytes ; p++ )
+    for(int p = k ; p < n ; p++ )
     {
-        // reading file
-        display = in->textChunk[p];
+        int cls = charClass(cps[p]);
 
-        bool special = false;
-        bool pastInWord = inWord;
-        // UTF-8  -->  E280**
-        if( display == 226){
-            p++;
-            display = in->textChunk[p];
-            special = true;
-            p++;
-            display = in->textChunk[p];
-        }
-        // end of file indicator
-        //if ( !(p<in->numBytes) ) break;
-        
-        //printf("%i\n", display);
-        if( prev != 195 ){
-            bool tmpInWord = true;
-            if(!inWord) if ( display == 95 ) tmpInWord = true;
-            if(inWord) if ( display == 39 || display == 95 || ( special && display == 152 ) || ( special && display == 153 )) tmpInWord = true;
-            if(inWord) for (int i = 0; i < arrLen; i++ ) if (newWord[i] == display || ( special && display == 93 ) || ( special && display == 148 )) tmpInWord = false;
-            if(!inWord) for (int i = 0; i < arrLen; i++) if (newWord[i] == display || display == 39 || ( special && display == 93 ) || ( special && display == 152 ) || ( special && display == 153 ) || ( special && display == 148 )) tmpInWord = false;
-            inWord = tmpInWord;
-            if( !pastInWord && inWord ) w++;
-            if( pastInWord && !inWord )
-            {
-                aFlag = true;
-                eFlag = true;
-                iFlag = true;
-                oFlag = true;
-                uFlag = true;
-                cFlag = true;
-                yFlag = true;
-            }
-        }
-        // UTF-8  -->  C3**
-        if( display == 195) go = true;
-        if( aFlag )
-        {
-            if( display == 65 || display == 97 || ( go && ( display == 128 || display == 129 || display == 130 || display == 131 || display == 160 || display == 161 || display == 162 || display == 163)))
-            {
-                a++;
-                aFlag = false;
-            }
-        }
-        if( eFlag )
-        {
-            if( display == 69 || display == 101 || ( go && ( display == 168 || display == 169 || display == 170 || display == 136 || display == 137 || display == 138 )))
-            {
-                e++;
-                eFlag = false;
-            }
-        }
-        if( iFlag )
-        {
-            if( display == 73 || display == 105 || ( go && ( display == 172 || display == 173 || display == 140 || display == 141 )))
-            {
-                i++;
-                iFlag = false;
-            }
-        }
-        if( oFlag )
-        {
-            if( display == 79 || display == 111 || ( go && ( display == 178 || display == 179 || display == 180 || display == 181 || display == 146 || display == 147 || display == 148 || display == 149)))
-            {
-                o++;
-                oFlag = false;
-            }
-        }
-        if( uFlag )
-        {
-            if( display == 85 || display == 117 || ( go && ( display == 185 || display == 186 || display == 153 || display == 154 )))
-            {
-                u++;
-                uFlag = false;
-            }
-        }
-        if( cFlag )
+        if( inWord && cls == SEPARATOR )
         {
-            if(( go && ( display == 167 || display == 135 )))
-            {
-                c++;
-                cFlag = false;
-            }
+            inWord = false;
+            found = 0;
         }
-        if( yFlag )
+        else if( !inWord && cls == LETTER )
         {
-            if(display == 89 || display == 121 )
-            {
-                y++;
-                yFlag = false;
-            }
+            inWord = true;
+            w++;
         }
-        if( display != 195 ) go = false;   
 
-        // displaying every characters
-        //printf("%x ", display);
-        prev = display;
+        int mask = vowelMask(cps[p]) & ~found;
+        if( mask == 0 ) continue;
+        found |= mask;
+        if( mask & A_BIT ) a++;
+        if( mask & E_BIT ) e++;
+        if( mask & I_BIT ) i++;
+        if( mask & O_BIT ) o++;
+        if( mask & U_BIT ) u++;
+        if( mask & C_BIT ) c++;
+        if( mask & Y_BIT ) y++;
     }
     out->fileID = in->fileID;
+    out->nInvalid = in->nInvalid;
     out->nWords = w;
     out->a = a;
     out->e = e;
@@ -155,10 +171,5 @@ void count(Chunk *in, TempResults *out)
     out->u = u;
     out->c = c;
     out->y = y;
-    // printf("\nA: %i \n", a);
-    // printf("\nE: %i \n", e);
-    // printf("\nI: %i \n", i);
-    // printf("\nO: %i \n", o);
-    // printf("\nU: %i \n", u);
-    // printf("Words: %i \n", w);
+    if( out->patternCounts != NULL ) searchPatterns(cps, n, k, out->patternCounts);
 }
@@ -11,6 +11,24 @@
 
 #include "dataStructures.h"
 
+/** \brief character that separates words */
+#define SEPARATOR    0
+
+/** \brief character that belongs to a word */
+#define LETTER       1
+
+/** \brief character that continues a word, but does not start one (apostrophes) */
+#define JOINER       2
+
+/**
+ *  \brief Classifies a code point for the word splitting rules
+ *
+ *  \param cp code point
+ *
+ *  \return SEPARATOR, LETTER or JOINER
+ */
+extern int charClass(int cp);
+
 /**
  *  \brief Counts the number of words and words with A, E, I, O, U, Y and Ç
  * 
@@ -19,4 +37,21 @@
  */
 extern void count(Chunk *in, TempResults *out);
 
-#endif /* COUNTWORDS_H_ */
\ No newline at end of file
+/**
+ *  \brief Decodes a chunk into code points, validating it
+ *
+ *  \param in chunk of data
+ *  \param out decoded chunk
+ *  \param withContext flag signaling the context repeated from the previous chunk must be decoded as well
+ */
+extern void decode(Chunk *in, DecodedChunk *out, bool withContext);
+
+/**
+ *  \brief Counts the number of words and words with A, E, I, O, U, Y and Ç of a decoded chunk
+ *
+ *  \param in decoded chunk
+ *  \param out partial results of this chunk
+ */
+extern void countDecoded(DecodedChunk *in, TempResults *out);
+
+#endif /* COUNTWORDS_H_ */
@@ -7,15 +7,37 @@
  */
 #ifndef DATASTRUCT_H
 #define DATASTRUCT_H
+
+#include "probConst.h"
+
 /**
  * \brief Struct to store a chunk of a file
  */
 typedef struct
 {
     int numBytes;
+    int overlap;
     int fileID;
-    int textChunk[6000];
+    int index;                                                 /* index of the chunk in its file, for tracing */
+    unsigned char textChunk[MAXCHUNK];
 } Chunk;
+
+/**
+ * \brief Struct to store a chunk decoded into code points
+ */
+typedef struct
+{
+    int fileID;
+    int index;
+    int ownStart;
+    int n;
+    int nInvalid;
+    int numBytes;
+    unsigned long long key;
+    int overlap;
+    unsigned char textChunk[MAXCHUNK];                    /* the bytes, kept only for the cache of chunk results */
+    int cps[MAXCHUNK];
+} DecodedChunk;
 /**
  * \brief Struct to store the partial results from a worker thread.
  *
@@ -23,14 +45,16 @@ typedef struct
 typedef struct
 {
     int fileID;
-    int nWords;
+    long long nWords;
     int fix;
-    int a;
-    int e;
-    int i;
-    int o;
-    int u;
-    int c;
-    int y;
+    long long a;
+    long long e;
+    long long i;
+    long long o;
+    long long u;
+    long long c;
+    long long y;
+    long long nInvalid;
+    int *patternCounts;
 } TempResults;
 #endif /* DATASTRUCT_H */
\ No newline at end of file
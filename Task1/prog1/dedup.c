@@ -0,0 +1,441 @@
+/**
+ *  \file dedup.c (implementation file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Detection of repeated content, so that it is counted only once.
+ *
+ *  The cache of chunk results is direct mapped: a chunk replaces whichever chunk was kept in its slot, so it keeps
+ *  the recent chunks without growing with the input. Each slot keeps the bytes of its chunk, so that a chunk with
+ *  the same hash is only taken as the same when its bytes are.
+ *
+ *  Definition of the operations:
+ *     \li findDuplicateFiles
+ *     \li chunkKey
+ *     \li dedupFind
+ *     \li dedupKeep
+ *     \li countChunk
+ *     \li dedupReport.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+#include "probConst.h"
+#include "dataStructures.h"
+#include "countWords.h"
+#include "planner.h"
+#include "patterns.h"
+#include "dedup.h"
+#include "utils.h"
+
+/** \brief repeated content to skip: DEDUP_NONE, DEDUP_FILES or DEDUP_CHUNKS */
+int dedupMode = DEDUP_NONE;
+
+/**
+ * \brief Struct to store the results of a chunk in the cache
+ */
+typedef struct
+{
+    unsigned long long key;
+    int numBytes;                                                                /* 0 if the slot is still empty */
+    int overlap;
+    unsigned char *bytes;                                                        /* MAXCHUNK bytes of the cache */
+    TempResults res;
+} CacheEntry;
+
+/** \brief cache of chunk results */
+static CacheEntry *cache;
+
+/** \brief occurrences of the patterns in the chunks of the cache */
+static int *cacheCounts;
+
+/** \brief bytes of the chunks of the cache */
+static unsigned char *cacheBytes;
+
+/** \brief number of files */
+static int nFilesSeen;
+
+/** \brief number of files with the same contents as an earlier one */
+static int nDupFiles;
+
+/** \brief bytes of all files */
+static long long totalBytes;
+
+/** \brief bytes of the files with the same contents as an earlier one */
+static long long dupFileBytes;
+
+/** \brief time spent hashing and comparing files, in seconds */
+static double hashTime;
+
+/** \brief number of chunks looked for in the cache */
+static long long nChunks;
+
+/** \brief number of chunks found in the cache */
+static long long nDupChunks;
+
+/** \brief bytes of the chunks found in the cache */
+static long long dupChunkBytes;
+
+/** \brief bytes of the chunks counted */
+static long long countedBytes;
+
+/** \brief time spent counting chunks, in seconds */
+static double countTime;
+
+/** \brief locking flag which warrants mutual exclusion on the cache and the statistics */
+static pthread_mutex_t accessCR = PTHREAD_MUTEX_INITIALIZER;
+
+/** \brief name of the critical region, for error reporting */
+static const char region[] = "cache of chunk results";
+
+/** \brief flag which warrants that the cache is allocated exactly once */
+static pthread_once_t init = PTHREAD_ONCE_INIT;
+
+/**
+ *  \brief Allocate the cache of chunk results.
+ *
+ *  Internal operation, called exactly once.
+ */
+
+static void cacheInit (void)
+{
+  if (((cache = calloc (DEDUPSLOTS, sizeof (CacheEntry))) == NULL) ||
+      ((cacheCounts = calloc ((size_t) DEDUPSLOTS * nPatterns + 1, sizeof (int))) == NULL) ||
+      ((cacheBytes = malloc ((size_t) DEDUPSLOTS * MAXCHUNK)) == NULL))
+     { fprintf (stderr, "error on allocating space to the cache of chunk results\n");
+       exit (EXIT_FAILURE);
+     }
+  for (int s = 0; s < DEDUPSLOTS; s++)
+  { cache[s].bytes = cacheBytes + (size_t) s * MAXCHUNK;
+    cache[s].res.patternCounts = (nPatterns > 0) ? cacheCounts + (size_t) s * nPatterns : NULL;
+  }
+}
+
+/**
+ *  \brief Mix a 64-bit word into a hash.
+ *
+ *  Internal operation.
+ *
+ *  \param h hash
+ *  \param w word
+ *
+ *  \return new hash
+ */
+
+static inline uint64_t mix (uint64_t h, uint64_t w)
+{
+  h ^= w * 0x9E3779B97F4A7C15ULL;
+  h = (h << 31) | (h >> 33);
+  return h * 0x94D049BB133111EBULL;
+}
+
+/**
+ *  \brief Hash a sequence of bytes, eight at a time.
+ *
+ *  Internal operation.
+ *
+ *  \param h hash of the bytes before, or a seed
+ *  \param bytes bytes to hash
+ *  \param n number of bytes
+ *
+ *  \return new hash
+ */
+
+static uint64_t hashBytes (uint64_t h, const unsigned char *bytes, size_t n)
+{
+  uint64_t w;
+
+  for (; n >= sizeof (w); bytes += sizeof (w), n -= sizeof (w))
+  { memcpy (&w, bytes, sizeof (w));
+    h = mix (h, w);
+  }
+  w = (uint64_t) n << 56;                                                    /* the tail, and its length */
+  memcpy (&w, bytes, n);
+  h = mix (h, w);
+  h ^= h >> 32;                                                                            /* final avalanche */
+  return h * 0xBF58476D1CE4E5B9ULL;
+}
+
+/**
+ *  \brief Hash the contents of a file.
+ *
+ *  Internal operation.
+ *
+ *  \param fileName name of the file
+ *  \param hash returns the hash
+ *
+ *  \return true if the file could be read
+ */
+
+static bool hashFile (const char *fileName, uint64_t *hash)
+{
+  static unsigned char block[BLOCKSIZE];
+  FILE *fp;
+  size_t n;
+
+  if ((fp = fopen (fileName, "rb")) == NULL) return false;
+  *hash = 0;
+  while ((n = fread (block, 1, BLOCKSIZE, fp)) > 0)
+    *hash = hashBytes (*hash, block, n);
+  bool ok = !ferror (fp);
+  fclose (fp);
+
+  return ok;
+}
+
+/**
+ *  \brief Compare the contents of two files of the same size.
+ *
+ *  Internal operation.
+ *
+ *  \param name1 name of the first file
+ *  \param name2 name of the second file
+ *
+ *  \return true if both files could be read and have the same bytes
+ */
+
+static bool sameFile (const char *name1, const char *name2)
+{
+  static unsigned char block1[BLOCKSIZE], block2[BLOCKSIZE];
+  FILE *fp1, *fp2;
+  size_t n1, n2;
+  bool same = true;
+
+  if ((fp1 = fopen (name1, "rb")) == NULL) return false;
+  if ((fp2 = fopen (name2, "rb")) == NULL)
+     { fclose (fp1);
+       return false;
+     }
+  do
+  { n1 = fread (block1, 1, BLOCKSIZE, fp1);
+    n2 = fread (block2, 1, BLOCKSIZE, fp2);
+    same = (n1 == n2) && (memcmp (block1, block2, n1) == 0);
+  } while (same && (n1 > 0));
+  same = same && !ferror (fp1) && !ferror (fp2);
+  fclose (fp1);
+  fclose (fp2);
+
+  return same;
+}
+
+/** \brief size of each file, while the duplicates are found */
+static off_t *sizes;
+
+/** \brief hash of each file, while the duplicates are found */
+static uint64_t *hashes;
+
+/**
+ *  \brief Compare two files by size, then by hash, then by position.
+ *
+ *  Internal operation.
+ *
+ *  \param a pointer to the identification of the first file
+ *  \param b pointer to the identification of the second file
+ *
+ *  \return negative, zero or positive, as the first file goes before, with or after the second one
+ */
+
+static int bySizeAndHash (const void *a, const void *b)
+{
+  int f = *(const int *) a, g = *(const int *) b;
+
+  if (sizes[f] != sizes[g]) return (sizes[f] < sizes[g]) ? -1 : 1;
+  if (hashes[f] != hashes[g]) return (hashes[f] < hashes[g]) ? -1 : 1;
+  return f - g;
+}
+
+/**
+ *  \brief Find the files with the same contents as an earlier one.
+ *
+ *  Only files with the same size as some other file are read, and files with the same size and hash are compared
+ *  byte by byte.
+ *
+ *  \param nFiles number of files
+ *  \param fileNames names of the files
+ *
+ *  \return array with the earliest file with the same contents as each file, or -1 if there is none
+ */
+
+int *findDuplicateFiles (int nFiles, char *fileNames[])
+{
+  int *sameAs, *order;
+  bool *hashed;
+  double start = now ();
+
+  if (((sameAs = malloc ((nFiles + 1) * sizeof (int))) == NULL) ||
+      ((order = malloc ((nFiles + 1) * sizeof (int))) == NULL) ||
+      ((hashed = calloc (nFiles + 1, sizeof (bool))) == NULL) ||
+      ((sizes = malloc ((nFiles + 1) * sizeof (off_t))) == NULL) ||
+      ((hashes = calloc (nFiles + 1, sizeof (uint64_t))) == NULL))
+     { fprintf (stderr, "error on allocating space to the duplicate files\n");
+       exit (EXIT_FAILURE);
+     }
+  nFilesSeen = nFiles;
+  for (int f = 0; f < nFiles; f++)
+  { order[f] = f;
+    sameAs[f] = -1;
+    sizes[f] = fileSize (fileNames[f]);
+    totalBytes += sizes[f];
+  }
+  qsort (order, nFiles, sizeof (int), bySizeAndHash);                             /* files of the same size together */
+  for (int k = 0; k < nFiles; k++)                                      /* only files which share their size are read */
+    if (((k > 0) && (sizes[order[k - 1]] == sizes[order[k]])) ||
+        ((k + 1 < nFiles) && (sizes[order[k + 1]] == sizes[order[k]])))
+       hashed[order[k]] = hashFile (fileNames[order[k]], &hashes[order[k]]);
+  qsort (order, nFiles, sizeof (int), bySizeAndHash);                               /* same hash together, in order */
+  for (int first = 0, k = 1; k < nFiles; k++)
+  { int f = order[k];
+    if (!hashed[f] || (sizes[f] != sizes[order[k - 1]]) || (hashes[f] != hashes[order[k - 1]]))
+       { first = k;                                                          /* the first file with this hash */
+         continue;
+       }
+    for (int j = first; (j < k) && (sameAs[f] < 0); j++)               /* against each earlier distinct content */
+      if ((sameAs[order[j]] < 0) && sameFile (fileNames[order[j]], fileNames[f]))
+         { sameAs[f] = order[j];
+           nDupFiles += 1;
+           dupFileBytes += sizes[f];
+         }
+  }
+  free (order);
+  free (hashed);
+  free (sizes);
+  free (hashes);
+  hashTime = now () - start;
+
+  return sameAs;
+}
+
+/**
+ *  \brief Get the key of a chunk in the cache of chunk results.
+ *
+ *  \param chunk chunk
+ *
+ *  \return hash of the bytes of the chunk, its context included
+ */
+
+unsigned long long chunkKey (const Chunk *chunk)
+{
+  return hashBytes (((uint64_t) chunk->overlap << 32) | (uint64_t) chunk->numBytes, chunk->textChunk, chunk->numBytes);
+}
+
+/**
+ *  \brief Look for the results of a chunk in the cache of chunk results.
+ *
+ *  \param key key of the chunk
+ *  \param chunk chunk
+ *  \param res returns the results of the chunk, if found (the occurrences of the patterns are copied to the array
+ *         of the caller)
+ *
+ *  \return true if the results were found
+ */
+
+bool dedupFind (unsigned long long key, const Chunk *chunk, TempResults *res)
+{
+  pthread_once (&init, cacheInit);
+  CacheEntry *entry = &cache[key % DEDUPSLOTS];
+  int *counts = res->patternCounts;
+
+  lock (&accessCR, region);
+  nChunks += 1;
+  bool found = (entry->numBytes == chunk->numBytes) && (entry->key == key) && (entry->overlap == chunk->overlap) &&
+               (memcmp (entry->bytes, chunk->textChunk, chunk->numBytes) == 0);
+  if (found)
+     { *res = entry->res;
+       res->fileID = chunk->fileID;
+       res->patternCounts = counts;
+       if (counts != NULL) memcpy (counts, entry->res.patternCounts, nPatterns * sizeof (int));
+       nDupChunks += 1;
+       dupChunkBytes += chunk->numBytes;
+     }
+  unlock (&accessCR, region);
+
+  return found;
+}
+
+/**
+ *  \brief Store the results of a chunk in the cache of chunk results.
+ *
+ *  \param key key of the chunk
+ *  \param bytes bytes of the chunk
+ *  \param numBytes number of bytes of the chunk
+ *  \param overlap number of bytes of context at the start of the chunk
+ *  \param res results of the chunk
+ *  \param seconds time it took to count the chunk
+ */
+
+void dedupKeep (unsigned long long key, const unsigned char *bytes, int numBytes, int overlap, TempResults *res,
+                double seconds)
+{
+  pthread_once (&init, cacheInit);
+  CacheEntry *entry = &cache[key % DEDUPSLOTS];
+
+  lock (&accessCR, region);
+  countedBytes += numBytes;
+  countTime += seconds;
+  if (dedupMode == DEDUP_CHUNKS)
+     { int *counts = entry->res.patternCounts;                                   /* keep the storage of the slot */
+       entry->key = key;
+       entry->numBytes = numBytes;
+       entry->overlap = overlap;
+       memcpy (entry->bytes, bytes, numBytes);
+       entry->res = *res;
+       entry->res.patternCounts = counts;
+       if ((counts != NULL) && (res->patternCounts != NULL))
+          memcpy (counts, res->patternCounts, nPatterns * sizeof (int));
+     }
+  unlock (&accessCR, region);
+}
+
+/**
+ *  \brief Count a chunk, unless its results are in the cache of chunk results.
+ *
+ *  \param chunk chunk
+ *  \param res returns the results of the chunk
+ */
+
+void countChunk (Chunk *chunk, TempResults *res)
+{
+  unsigned long long key = 0;
+
+  if (dedupMode == DEDUP_NONE)
+     { count (chunk, res);
+       return;
+     }
+  if (dedupMode == DEDUP_CHUNKS)
+     { key = chunkKey (chunk);
+       if (dedupFind (key, chunk, res)) return;
+     }
+  double t = now ();
+  count (chunk, res);
+  dedupKeep (key, chunk->textChunk, chunk->numBytes, chunk->overlap, res, now () - t);
+}
+
+/**
+ *  \brief Print the amount of repeated content found and an estimate of the time saved by not counting it.
+ *
+ *  The time saved is the time the skipped bytes would have taken to count, at the rate of the bytes counted, less
+ *  the time spent hashing and comparing the files.
+ *
+ *  \param fp stream to print to
+ */
+
+void dedupReport (FILE *fp)
+{
+  double perByte = (countedBytes > 0) ? countTime / countedBytes : 0.0;
+
+  fprintf (fp, "Duplicate files = %d of %d (%.1f%% of the bytes)\n", nDupFiles, nFilesSeen,
+           (totalBytes > 0) ? 100.0 * dupFileBytes / totalBytes : 0.0);
+  if (dedupMode == DEDUP_CHUNKS)
+     fprintf (fp, "Duplicate chunks = %lld of %lld (%.1f%% of the bytes counted)\n", nDupChunks, nChunks,
+              (countedBytes + dupChunkBytes > 0) ? 100.0 * dupChunkBytes / (countedBytes + dupChunkBytes) : 0.0);
+  fprintf (fp, "Counting time saved = %.6f s (hashing and comparing the files took %.6f s)\n",
+           (dupFileBytes + dupChunkBytes) * perByte - hashTime, hashTime);
+}
@@ -0,0 +1,101 @@
+/**
+ *  \file dedup.h (interface file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Detection of repeated content, so that it is counted only once.
+ *
+ *  Files with the same size are hashed before counting, and a file with the same contents as an earlier one is not
+ *  counted: it gets the results of that file. Optionally, the results of each chunk are also kept in a cache, keyed
+ *  by a hash of its bytes, and a chunk found there is not counted again. Results are reported as if every copy had
+ *  been counted.
+ *
+ *  The hash is a fast 64-bit non-cryptographic one, so it only finds the candidates: files with the same hash are
+ *  compared byte by byte, and chunks with the bytes kept in the cache.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#ifndef DEDUP_H
+#define DEDUP_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "dataStructures.h"
+
+/** \brief every file and chunk is counted */
+#define DEDUP_NONE     0
+
+/** \brief files with the same contents as an earlier one are not counted */
+#define DEDUP_FILES    1
+
+/** \brief as DEDUP_FILES, and chunks with the same bytes as a recent one are not counted either */
+#define DEDUP_CHUNKS   2
+
+/** \brief repeated content to skip: DEDUP_NONE, DEDUP_FILES or DEDUP_CHUNKS */
+extern int dedupMode;
+
+/**
+ *  \brief Find the files with the same contents as an earlier one.
+ *
+ *  Only files with the same size as some other file are read, and files with the same size and hash are compared
+ *  byte by byte.
+ *
+ *  \param nFiles number of files
+ *  \param fileNames names of the files
+ *
+ *  \return array with the earliest file with the same contents as each file, or -1 if there is none
+ */
+extern int *findDuplicateFiles (int nFiles, char *fileNames[]);
+
+/**
+ *  \brief Get the key of a chunk in the cache of chunk results.
+ *
+ *  \param chunk chunk
+ *
+ *  \return hash of the bytes of the chunk, its context included
+ */
+extern unsigned long long chunkKey (const Chunk *chunk);
+
+/**
+ *  \brief Look for the results of a chunk in the cache of chunk results.
+ *
+ *  \param key key of the chunk
+ *  \param chunk chunk
+ *  \param res returns the results of the chunk, if found (the occurrences of the patterns are copied to the array
+ *         of the caller)
+ *
+ *  \return true if the results were found
+ */
+extern bool dedupFind (unsigned long long key, const Chunk *chunk, TempResults *res);
+
+/**
+ *  \brief Store the results of a chunk in the cache of chunk results.
+ *
+ *  \param key key of the chunk
+ *  \param bytes bytes of the chunk
+ *  \param numBytes number of bytes of the chunk
+ *  \param overlap number of bytes of context at the start of the chunk
+ *  \param res results of the chunk
+ *  \param seconds time it took to count the chunk
+ */
+extern void dedupKeep (unsigned long long key, const unsigned char *bytes, int numBytes, int overlap, TempResults *res,
+                       double seconds);
+
+/**
+ *  \brief Count a chunk, unless its results are in the cache of chunk results.
+ *
+ *  \param chunk chunk
+ *  \param res returns the results of the chunk
+ */
+extern void countChunk (Chunk *chunk, TempResults *res);
+
+/**
+ *  \brief Print the amount of repeated content found and an estimate of the time saved by not counting it.
+ *
+ *  \param fp stream to print to
+ */
+extern void dedupReport (FILE *fp);
+
+#endif /* DEDUP_H */
@@ -22,11 +22,24 @@
 #include <math.h>
 #include <time.h>
 #include <stdlib.h>
+#include <sys/resource.h>
 
 #include "probConst.h"
 #include "fifo.h"
 #include "countWords.h"
 #include "sharedRegion.h"
+#include "chunkReader.h"
+#include "processes.h"
+#include "shard.h"
+#include "planner.h"
+#include "trace.h"
+#include "chunkIndex.h"
+#include "patterns.h"
+#include "checkpoint.h"
+#include "pipeline.h"
+#include "dedup.h"
+#include "sampler.h"
+#include "utils.h"
 
 /** \brief return status on monitor initialization */
 int statusInitMon;
@@ -40,14 +53,74 @@ int* statusWorkers;
 /** \brief number of storage positions in the data transfer region */
 int nStorePos = K;
 
+/** \brief flag signaling decomposed diacritics must be composed before counting */
+bool normalizeNFC = false;
+
+/** \brief output format of the results */
+int outFormat = OUT_TEXT;
+
+/** \brief maximum number of worker threads to be created */
+static int nThreads = N;
+
+/** \brief execution plan requested by the user */
+static int requestedPlan = PLAN_AUTO;
+
+/** \brief flag signaling the execution plan must be printed */
+static bool verbose = false;
+
+/** \brief names of files being counted */
+static char **inFiles;
+
+/** \brief name of the file to store the trace of the chunk life cycle */
+static char *tracePath = NULL;
+
+/** \brief flag signaling the chunk index of each file must be stored */
+static bool buildIndex = false;
+
+/** \brief flag signaling the files must be scheduled in the order they were given */
+static bool argOrder = false;
+
+/** \brief name of the file to store the checkpoints of the run */
+static char *ckptPath = NULL;
+
+/** \brief flag signaling the run must be resumed from its last checkpoint */
+static bool resume = false;
+
+/** \brief number of threads of each stage of the pipeline (0 threads to count: as many as the worker threads) */
+static int stageThreads[NSTAGES] = { 1, 1, 0, 0 };
+
+/** \brief earliest file with the same contents as each file, or -1 (NULL if duplicates are not looked for) */
+static int *sameAs = NULL;
+
+/** \brief time each worker thread spent counting, in seconds */
+static double *busyTime;
+
 /** \brief worker life cycle routine */
 static void *worker (void *id);
 
+/** \brief life cycle routine of a worker which counts whole files */
+static void *fileWorker (void *id);
+
+/** \brief count a whole file */
+static bool countFile (int fileID, Chunk *chunk, TempResults *total, int slot);
+
+/** \brief count a list of files with the producer / workers pipeline */
+static void processFiles (int nFiles, char *fileNames[]);
+
+/** \brief split a list of files in chunks and store them in the data transfer region */
+static void splitFiles (int nFiles, char *fileNames[], int *order, int window);
+
+/** \brief record the results of the files counted in a final checkpoint */
+static void finalCheckpoint (int nFiles, char *fileNames[]);
+
+/** \brief count a range of each file of a list */
+static void processQueries (int nFiles, char *fileNames[], Range *range);
+
 /** \brief execution time measurement */
 static double get_delta_time(void);
 
-// /** \brief print command usage */
-// static void printUsage (char *cmdName);
+/** \brief print command usage */
+static void printUsage (char *cmdName);
 
 /**
  *  \brief Main thread.
@@ -63,156 +136,637 @@ static double get_delta_time(void);
 
 int main (int argc, char *argv[])
 {
-  int nThreads = N;                                                               /* number of threads to be created */
-
-  if( strcmp(argv[1],"-t") == 0 ) nThreads = *argv[2] - '0';  /* number of threads to be created */
+  int opt;                                                                                         /* selected option */
+  int nProcs = 1;                                                          /* number of worker processes to be created */
+  char *shardPath = NULL;                                                   /* name of the shard to store the results */
+  bool merge = false;                                                     /* flag signaling the arguments are shards */
+  char *querySpec = NULL;                                                            /* range of the files to count */
+  Range range;                                                                       /* parsed range of the files */
+  char *patternPath = NULL;                                                     /* name of the file of patterns */
+
+  opterr = 0;
+  do
+  { switch ((opt = getopt (argc, argv, "t:nf:p:o:mx:P:vT:iq:w:ac:rd:s:h")))
+    { case 't': /* number of threads to be created */
+                if (atoi (optarg) <= 0)
+                   { fprintf (stderr, "%s: non positive number\n", basename (argv[0]));
+                     printUsage (basename (argv[0]));
+                     return EXIT_FAILURE;
+                   }
+                nThreads = (int) atoi (optarg);
+                break;
+      case 'n': /* compose decomposed diacritics */
+                normalizeNFC = true;
+                break;
+      case 'f': /* output format */
+                if (strcmp (optarg, "text") == 0) outFormat = OUT_TEXT;
+                else if (strcmp (optarg, "json") == 0) outFormat = OUT_JSON;
+                else if (strcmp (optarg, "csv") == 0) outFormat = OUT_CSV;
+                else { fprintf (stderr, "%s: unknown output format\n", basename (argv[0]));
+                       printUsage (basename (argv[0]));
+                       return EXIT_FAILURE;
+                     }
+                break;
+      case 'p': /* number of worker processes to be created */
+                if (atoi (optarg) <= 0)
+                   { fprintf (stderr, "%s: non positive number\n", basename (argv[0]));
+                     printUsage (basename (argv[0]));
+                     return EXIT_FAILURE;
+                   }
+                nProcs = (int) atoi (optarg);
+                break;
+      case 'o': /* shard to store the results */
+                shardPath = optarg;
+                break;
+      case 'm': /* merge mode */
+                merge = true;
+                break;
+      case 'x': /* execution plan */
+                if (strcmp (optarg, "auto") == 0) requestedPlan = PLAN_AUTO;
+                else if (strcmp (optarg, "seq") == 0) requestedPlan = PLAN_SEQUENTIAL;
+                else if (strcmp (optarg, "file") == 0) requestedPlan = PLAN_PER_FILE;
+                else if (strcmp (optarg, "split") == 0) requestedPlan = PLAN_SPLIT;
+                else if (strcmp (optarg, "pipe") == 0) requestedPlan = PLAN_PIPELINE;
+                else { fprintf (stderr, "%s: unknown execution plan\n", basename (argv[0]));
+                       printUsage (basename (argv[0]));
+                       return EXIT_FAILURE;
+                     }
+                break;
+      case 'P': /* threads of each stage of the pipeline */
+                if (!parseStages (optarg, stageThreads))
+                   { fprintf (stderr, "%s: invalid number of threads of the stages\n", basename (argv[0]));
+                     printUsage (basename (argv[0]));
+                     return EXIT_FAILURE;
+                   }
+                requestedPlan = PLAN_PIPELINE;
+                break;
+      case 'v': /* verbose mode */
+                verbose = true;
+                break;
+      case 'T': /* trace of the chunk life cycle */
+                tracePath = optarg;
+                break;
+      case 'i': /* store the chunk index of each file */
+                buildIndex = true;
+                break;
+      case 'q': /* range query */
+                if (!parseRange (optarg, &range))
+                   { fprintf (stderr, "%s: invalid range\n", basename (argv[0]));
+                     printUsage (basename (argv[0]));
+                     return EXIT_FAILURE;
+                   }
+                querySpec = optarg;
+                break;
+      case 'w': /* patterns to search */
+                patternPath = optarg;
+                break;
+      case 'a': /* schedule the files in the order given */
+                argOrder = true;
+                break;
+      case 'c': /* checkpoints of the run */
+                ckptPath = optarg;
+                break;
+      case 'r': /* resume from the last checkpoint */
+                resume = true;
+                break;
+      case 'd': /* repeated content to skip */
+                if (strcmp (optarg, "files") == 0) dedupMode = DEDUP_FILES;
+                else if (strcmp (optarg, "chunks") == 0) dedupMode = DEDUP_CHUNKS;
+                else { fprintf (stderr, "%s: unknown duplicate detection\n", basename (argv[0]));
+                       printUsage (basename (argv[0]));
+                       return EXIT_FAILURE;
+                     }
+                break;
+      case 's': /* sample the chunks of each file */
+                if ((atof (optarg) <= 0.0) || (atof (optarg) >= 1.0))
+                   { fprintf (stderr, "%s: the precision must be between 0 and 1\n", basename (argv[0]));
+                     printUsage (basename (argv[0]));
+                     return EXIT_FAILURE;
+                   }
+                samplePrecision = atof (optarg);
+                break;
+      case 'h': /* help mode */
+                printUsage (basename (argv[0]));
+                return EXIT_SUCCESS;
+      case '?': /* invalid option */
+                fprintf (stderr, "%s: invalid option\n", basename (argv[0]));
+                printUsage (basename (argv[0]));
+                return EXIT_FAILURE;
+      case -1:  break;
+    }
+  } while (opt != -1);
+  if ((tracePath != NULL) && (nProcs > 1))
+     { fprintf (stderr, "%s: tracing is only supported by a single process\n", basename (argv[0]));
+       printUsage (basename (argv[0]));
+       return EXIT_FAILURE;
+     }
+  if ((patternPath != NULL) && ((nProcs > 1) || merge || (querySpec != NULL)))
+     { fprintf (stderr, "%s: patterns are only searched by a single process counting whole files\n",
+                basename (argv[0]));
+       printUsage (basename (argv[0]));
+       return EXIT_FAILURE;
+     }
+  if ((ckptPath == NULL) ? resume
+                        : ((nProcs > 1) || merge || (querySpec != NULL) || (requestedPlan == PLAN_PIPELINE)))
+     { fprintf (stderr, "%s: checkpoints are only taken by a single process counting whole files, and needed to "
+                "resume\n", basename (argv[0]));
+       printUsage (basename (argv[0]));
+       return EXIT_FAILURE;
+     }
+  if ((dedupMode != DEDUP_NONE) && ((nProcs > 1) || merge || (querySpec != NULL) || buildIndex))
+     { fprintf (stderr, "%s: duplicates are only skipped by a single process counting whole files, without "
+                "indexing them\n", basename (argv[0]));
+       printUsage (basename (argv[0]));
+       return EXIT_FAILURE;
+     }
+  if ((samplePrecision > 0.0) && ((nProcs > 1) || merge || (querySpec != NULL) || buildIndex ||
+                                   (patternPath != NULL) || (ckptPath != NULL) || (dedupMode != DEDUP_NONE)))
+     { fprintf (stderr, "%s: chunks are only sampled by a single process counting whole files, without patterns, "
+                "checkpoints, duplicates or an index\n", basename (argv[0]));
+       printUsage (basename (argv[0]));
+       return EXIT_FAILURE;
+     }
+  if ((patternPath != NULL) && (loadPatterns (patternPath) <= 0))
+     { fprintf (stderr, "%s: no patterns to search in %s\n", basename (argv[0]), patternPath);
+       return EXIT_FAILURE;
+     }
+  setChunkContext (patternContext ());
+  if (optind == argc)
+     { fprintf (stderr, "%s: no files to process\n", basename (argv[0]));
+       printUsage (basename (argv[0]));
+       return EXIT_FAILURE;
+     }
 
+  if (stageThreads[STAGE_COUNT] == 0) stageThreads[STAGE_COUNT] = nThreads;
+  int nSlots = nThreads;                   /* worker threads of any plan (the pipeline numbers its threads from 1) */
+  int pipelineThreads = 0;
+  for (int s = 0; s < NSTAGES; s++)
+    pipelineThreads += stageThreads[s];
+  if (pipelineThreads + 1 > nSlots) nSlots = pipelineThreads + 1;
 
-  if (((statusMain = malloc (sizeof (int))) == NULL))
+  if (((statusMain = malloc (nSlots * sizeof (int))) == NULL))
   { 
     fprintf (stderr, "error on allocating space to the return status arrays of producer / worker threads\n");
     exit (EXIT_FAILURE);
   }
-  if (((statusWorkers = malloc (nThreads * sizeof (int))) == NULL))
+  if (((statusWorkers = malloc (nSlots * sizeof (int))) == NULL))
   { 
     fprintf (stderr, "error on allocating space to the return status arrays of producer / worker threads\n");
     exit (EXIT_FAILURE);
   }
+  srandom ((unsigned int) getpid ());
+  (void) get_delta_time ();
+
+  int nFiles = argc - optind;                                                          /* number of files to process */
+  char **fileNames = &argv[optind];                                                    /* names of files to process */
+  int nFailed = 0;                                                           /* number of worker processes which failed */
+
+  if (merge) nFiles = mergeShards (nFiles, fileNames, &fileNames);
+  else if (querySpec != NULL) processQueries (nFiles, fileNames, &range);
+  else if (nProcs > 1) nFailed = runProcesses ((nProcs < nFiles) ? nProcs : nFiles, nFiles, fileNames, processFiles);
+  else processFiles (nFiles, fileNames);
+  printProcessingResults (0);
+
+  TempResults *res;                                                                          /* results of the files */
+  bool *processed;                                                        /* flags signaling each file was processed */
+  int nMissing = 0;                                                                 /* number of files not processed */
+
+  if (((res = malloc ((nFiles + 1) * sizeof (TempResults))) == NULL) ||
+      ((processed = malloc ((nFiles + 1) * sizeof (bool))) == NULL))
+     { fprintf (stderr, "error on allocating space to the results\n");
+       exit (EXIT_FAILURE);
+     }
+  for (int f = 0; f < nFiles; f++)
+  { res[f].patternCounts = NULL;
+    if (!(processed[f] = getFileResults (0, f, &res[f]))) nMissing += 1;
+  }
+  if (shardPath != NULL) writeShard (shardPath, nFiles, fileNames, res, processed);       /* store them in a shard */
+  free (res);
+  free (processed);
+
+  if (tracePath != NULL) traceWrite (tracePath);
+
+  FILE *report = (outFormat == OUT_TEXT) ? stdout : stderr;        /* keep machine readable output clean */
+  if (dedupMode != DEDUP_NONE)
+     { fputc ('\n', report);
+       dedupReport (report);
+     }
+  if (samplePrecision > 0.0)
+     { fputc ('\n', report);
+       sampleReport (report, nFiles, fileNames);
+     }
+  fprintf (report, "\nElapsed time = %.6f s\n", get_delta_time ());
+  if (verbose)
+     { struct rusage self, children;
+       getrusage (RUSAGE_SELF, &self);
+       getrusage (RUSAGE_CHILDREN, &children);
+       fprintf (report, "Peak resident set size = %ld KiB\n",
+                (self.ru_maxrss > children.ru_maxrss) ? self.ru_maxrss : children.ru_maxrss);
+     }
+
+  if (nMissing > 0) fprintf (stderr, "%d file(s) could not be processed\n", nMissing);
+  exit (((nFailed == 0) && (nMissing == 0)) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
 
+/**
+ *  \brief Count a list of files with the execution plan best suited to them.
+ *
+ *  Under the sequential plan the files are counted inline. Under the per file plan the worker threads take whole
+ *  files. Under the split plan the calling thread plays the role of producer: it splits the files in chunks and
+ *  stores them in the data transfer region, from where the worker threads retrieve them. Under the pipeline plan
+ *  the files are read, split, decoded and counted by stages with threads of their own. Unless the order given
+ *  is kept, the largest files are scheduled first, so that no large file is left to a single worker at the end.
+ *  When duplicates are looked for, a copy of an earlier file is never scheduled: it gets the results of that file.
+ *  The results are left in the shared region.
+ *
+ *  \param nFiles number of files
+ *  \param fileNames names of the files
+ */
+
+static void processFiles (int nFiles, char *fileNames[])
+{
   pthread_t* tIdWorkers;                                                          /* workers internal thread id array */
   unsigned int* work;                                               /* workers application defined thread id array */
   int i;                                                                                        /* counting variable */
   int *pStatus;                                                                       /* pointer to execution status */
+  FILE *report = (outFormat == OUT_TEXT) ? stdout : stderr;        /* keep machine readable output clean */
+  Plan plan = choosePlan (nFiles, fileNames, nThreads, requestedPlan, buildIndex || (samplePrecision > 0.0));
 
-  /* initializing the application defined thread id arrays for the producers and the workers and the random number
-     generator */
+  if (plan.kind == PLAN_PIPELINE)                                         /* threads of every stage of the pipeline */
+     { plan.nWorkers = 0;
+       for (i = 0; i < NSTAGES; i++)
+         plan.nWorkers += stageThreads[i];
+     }
+  if (verbose) printPlan (report, &plan);
+  if (tracePath != NULL) traceInit (plan.nWorkers);
+  inFiles = fileNames;
+  storeFileNames(0, nFiles, fileNames);
+  if (samplePrecision > 0.0) sampleInit (nFiles);
+  if (dedupMode != DEDUP_NONE)                              /* copies of an earlier file are not counted */
+     { sameAs = findDuplicateFiles (nFiles, fileNames);
+       storeFileCopies (0, sameAs);
+     }
+  if (ckptPath != NULL)
+     { checkpointInit (ckptPath, nFiles, fileNames, patternContext ());
+       if (resume && !checkpointLoad ()) fprintf (stderr, "%s: no checkpoint to resume from\n", ckptPath);
+       else if (resume && verbose) fprintf (report, "Resuming from the checkpoint %s\n", ckptPath);
+     }
+  if (outFormat != OUT_NONE) fprintf (report, "\nFinal report\n");            /* before any results are printed */
+
+  if (plan.kind == PLAN_SEQUENTIAL)                                    /* no worker threads, no data transfer */
+     { Chunk *chunk;                                                    /* chunk being filled, reused for every file */
+       TempResults res;
+       if ((chunk = (Chunk *) malloc (sizeof (Chunk))) == NULL)
+          { fprintf (stderr, "error on allocating space to the data chunk\n");
+            exit (EXIT_FAILURE);
+          }
+       res.patternCounts = newPatternCounts ();
+       for (int f = 0; f < nFiles; f++)
+         if ((sameAs == NULL) || (sameAs[f] == -1))
+            saveFileResults (0, f, countFile (f, chunk, &res, TRACE_MAIN) ? &res : NULL);
+       free (res.patternCounts);
+       free (chunk);
+       finalCheckpoint (nFiles, fileNames);
+       return;
+     }
+
+  if (plan.kind == PLAN_PIPELINE)                           /* the stages have threads and queues of their own */
+     { int *order = argOrder ? NULL : largestFirst (nFiles, fileNames);
+       storeFileOrder (0, order);
+       runPipeline (nFiles, fileNames, stageThreads, verbose ? report : NULL);
+       storeFileOrder (0, NULL);
+       free (order);
+       return;
+     }
+
+  /* initializing the application defined thread id arrays for the workers */
   if (
-      ((tIdWorkers = malloc (nThreads * sizeof (pthread_t))) == NULL) ||
-      ( ((work = malloc (nThreads * sizeof (unsigned int))) == NULL)))
+      ((tIdWorkers = malloc (plan.nWorkers * sizeof (pthread_t))) == NULL) ||
+      ( ((work = malloc (plan.nWorkers * sizeof (unsigned int))) == NULL)) ||
+      ((busyTime = calloc (plan.nWorkers, sizeof (double))) == NULL))
      { fprintf (stderr, "error on allocating space to both internal / external producer / worker id arrays\n");
        exit (EXIT_FAILURE);
      }
-  for (i = 0; i < nThreads; i++)
+  for (i = 0; i < plan.nWorkers; i++)
     work[i] = i;
-  srandom ((unsigned int) getpid ());
-  (void) get_delta_time ();
+
+  int *order = argOrder ? NULL : largestFirst (nFiles, fileNames);                 /* order of the files */
+  if (plan.kind == PLAN_PER_FILE) storeFileOrder (0, order);
 
   /* generation of intervening entities threads */
 
-  for (i = 0; i < nThreads; i++)
-    if (pthread_create (&tIdWorkers[i], NULL, worker, &work[i]) != 0)                             /* thread worker */
-       { perror ("error on creating thread worker");
+  double start = now ();                                                          /* start of the worker threads */
+  for (i = 0; i < plan.nWorkers; i++)
+    if (pthread_create (&tIdWorkers[i], NULL, (plan.kind == PLAN_PER_FILE) ? fileWorker : worker, &work[i]) != 0)
+       { perror ("error on creating thread worker");                                              /* thread worker */
          exit (EXIT_FAILURE);
        }
 
-  int starting = 0;
-  if ( strcmp(argv[1],"-t") == 0 ) starting = 2;
-  char* files[(argc - (starting + 1) )];
-  memset(files,0,(argc - (starting + 1) ));
-  for(int f = starting + 1 ; f < argc ; f++) files[f-(starting + 1)] = argv[f];
-  storeFileNames(0,argc-(starting+1),files);
-  for(int f = starting + 1 ; f < argc ; f++)
-  {
-    FILE * fp;
-    int display;
+  if (plan.kind == PLAN_SPLIT) splitFiles (nFiles, fileNames, order, argOrder ? 1 : INTERLEAVE);
 
-    if( fopen(argv[f], "r") == NULL ){
-        printf("File %s doesn't exist\n", argv[f]);
-        continue;
-    }
-    fp = fopen(argv[f], "r");
-    bool endF = false;
-    
-    bool inWord = false;
-    int newWord[] = {166,147,157,156,32,46,44,58,59,45,63,33,34,40,41,91,9,10,13,194,187,171};
-    int arrLen = sizeof newWord / sizeof newWord[0];
-    int prev = 0;
-    while (1) {
-      int textChunk[5000];
-      int b = 0;
-
-      while(1){
-        // reading file
-        display = fgetc(fp);
-        textChunk[b] = display;
-        bool special = false;
-        bool pastInWord = inWord;
-        // end of file indicator
-        if (feof(fp))
-        {
-          endF = true;
-          break;
-        } 
-        
-        // UTF-8  -->  E280**
-        if( display == 226)
-        {
-          display = fgetc(fp);
-          b += 1;
-          textChunk[b] = display;
-          display = fgetc(fp);
-          b += 1;
-          textChunk[b] = display;
-          special = true;
-        }
-        if( prev != 195 )
-        {
-          bool tmpInWord = true;
-          if(!inWord) if ( display == 95 ) tmpInWord = true;
-          if(inWord) if ( display == 39 || display == 95 || ( special && display == 152 ) || ( special && display == 153 )) tmpInWord = true;
-          if(inWord) for (int i = 0; i < arrLen; i++ ) if (newWord[i] == display || ( special && display == 93 ) || ( special && display == 148 )) tmpInWord = false;
-          if(!inWord) for (int i = 0; i < arrLen; i++) if (newWord[i] == display || display == 39 || ( special && display == 93 ) || ( special && display == 152 ) || ( special && display == 153 ) || ( special && display == 148 )) tmpInWord = false;
-          inWord = tmpInWord;
-          if( pastInWord && !inWord ) if(b >= 4096) break;
-        }
-        if( display == 195 )
-        {
-          display = fgetc(fp);
-          b += 1;
-          textChunk[b] = display;
-        }
-        // end of file indicator
-        if (feof(fp))
-        {
-          endF = true;
-          break;
-        } 
-        b +=1 ;
-        prev = display;
-      }
-      /* Create a data chunk*/
-      Chunk *save = (Chunk *)malloc(sizeof(Chunk));
-      save->fileID = f-(starting + 1);
-      save->numBytes = b;
-      for(int i = 0 ; i < b ; i++ )
-      {
-        save->textChunk[i] = textChunk[i];
-      }
-      if( endF && f == argc - 1) putChunk(0, *save, true );
-      else putChunk(0, *save, false );
-      //printf("%i\n",b);
+  /* waiting for the termination of the intervening entities threads */
 
-      if(endF) break;
+  for (i = 0; i < plan.nWorkers; i++)
+    if (pthread_join (tIdWorkers[i], (void *) &pStatus) != 0)                                       /* thread worker */
+       { perror ("error on waiting for thread customer");
+         exit (EXIT_FAILURE);
+       }
+  if (outFormat != OUT_NONE)                           /* after the results, which the workers print as they go */
+     { fprintf (report, "\nWorker threads\n");
+       for (i = 0; i < plan.nWorkers; i++)
+       { fprintf (report, "thread worker, with id %u, has terminated: ", i);
+         fprintf (report, "its status was %d\n", statusWorkers[i]);
+       }
+     }
+  if (verbose)                                                        /* time the workers were left without work */
+     { double span = plan.nWorkers * (now () - start);
+       double idle = span;
+       for (i = 0; i < plan.nWorkers; i++)
+         idle -= busyTime[i];
+       fprintf (report, "Worker idle time = %.6f s (%.1f%% of the worker time)\n", idle,
+                (span > 0.0) ? 100.0 * idle / span : 0.0);
+     }
+  finalCheckpoint (nFiles, fileNames);
+  storeFileOrder (0, NULL);
+  free (order);
+  free (busyTime);
+  free (tIdWorkers);
+  free (work);
+}
+
+/**
+ *  \brief Split a list of files in chunks and store them in the data transfer region.
+ *
+ *  The chunks of several files are interleaved, one chunk of each file in turn, taking the files in the given
+ *  order, so that the workers are kept busy with chunks of every large file until the very end. An empty chunk
+ *  signals the end of the work.
+ *
+ *  When checkpoints are taken, the producer waits for every chunk stored so far to be counted, so that the results
+ *  of each file cover exactly the bytes read from it, before recording its progress.
+ *
+ *  \param nFiles number of files
+ *  \param fileNames names of the files
+ *  \param order identifications of the files, in order (NULL for the order they were given)
+ *  \param window number of files whose chunks are interleaved
+ */
+
+static void splitFiles (int nFiles, char *fileNames[], int *order, int window)
+{
+  Chunk *chunk;                                           /* chunk being filled for each file of the window */
+  FILE **fp;                                                                    /* files of the window, if open */
+  int *nChunks;                                                       /* number of chunks of each file of the window */
+  int next = 0;                                                                            /* next file to be opened */
+  bool busy = true;                                                        /* flag signaling some file is open */
+  int totalPut = 0;                                                              /* number of chunks stored */
+  int *closed;                                                 /* files read to the end since the last checkpoint */
+  int nClosed = 0;
+  double last = 0.0;                                                                /* time of the last checkpoint */
+  TempResults res;                                                    /* results of a file, for the checkpoints */
+
+  if (window > nFiles) window = (nFiles > 0) ? nFiles : 1;
+  if (((chunk = (Chunk *) malloc (window * sizeof (Chunk))) == NULL) ||
+      ((fp = (FILE **) calloc (window, sizeof (FILE *))) == NULL) ||
+      ((nChunks = (int *) malloc (window * sizeof (int))) == NULL) ||
+      ((closed = (int *) malloc ((nFiles + 1) * sizeof (int))) == NULL))
+     { fprintf (stderr, "error on allocating space to the data chunk\n");
+       exit (EXIT_FAILURE);
+     }
+  res.patternCounts = newPatternCounts ();
+
+  while (busy)
+  { if (checkpointing && checkpointDue (&last))                       /* record the progress of the files */
+       { waitChunksCounted (0, totalPut);
+         for (int w = 0; w < window; w++)
+           if ((fp[w] != NULL) && getFileResults (0, chunk[w].fileID, &res))
+              checkpointFile (chunk[w].fileID, CKPT_PARTIAL, ftello (fp[w]), &res, &chunk[w]);
+         for (int k = 0; k < nClosed; k++)
+           if (getFileResults (0, closed[k], &res))
+              checkpointFile (closed[k], CKPT_DONE, fileSize (fileNames[closed[k]]), &res, NULL);
+         nClosed = 0;
+         checkpointWrite (true);
+       }
+    busy = false;
+    for (int w = 0; w < window; w++)
+    { while ((fp[w] == NULL) && (next < nFiles))                    /* the slot takes the next file, if any */
+      { int f = (order != NULL) ? order[next] : next;
+        next += 1;
+        if ((sameAs != NULL) && (sameAs[f] != -1)) continue;                    /* a copy of an earlier file */
+        if ((fp[w] = fopen (fileNames[f], "rb")) == NULL)
+           { fprintf (stderr, "File %s doesn't exist\n", fileNames[f]);
+             storeFileFailure (0, f);
+             continue;
+           }
+        chunk[w].fileID = f;
+        chunk[w].numBytes = 0;
+        nChunks[w] = 0;
+        off_t offset = 0;                                             /* bytes counted by an earlier run */
+        int state = checkpointRestore (f, &offset, &res, &chunk[w]);
+        if (state != CKPT_PENDING) storeResumedResults (0, &res);
+        if (state == CKPT_DONE)
+           { fclose (fp[w]);
+             fp[w] = NULL;
+             storeFileChunks (0, f, 0);
+           }
+        else fseeko (fp[w], offset, SEEK_SET);
+      }
+      if (fp[w] == NULL) continue;
+      busy = true;
+
+      int f = chunk[w].fileID;
+      double t = traceNow ();
+      chunk[w].index = nChunks[w];
+      bool endF = readChunk (fp[w], &chunk[w]);
+      traceEvent (TRACE_MAIN, "read", t, f, chunk[w].index, chunk[w].numBytes);
+      if (chunk[w].numBytes > chunk[w].overlap)
+         { t = traceNow ();
+           putChunk (0, chunk[w], false);
+           traceFlow (TRACE_MAIN, f, chunk[w].index, TRACE_PUT);
+           traceEvent (TRACE_MAIN, "putChunk", t, f, chunk[w].index, chunk[w].numBytes);
+           nChunks[w] += 1;
+           totalPut += 1;
+         }
+      if (endF)
+         { fclose (fp[w]);
+           fp[w] = NULL;
+           storeFileChunks (0, f, nChunks[w]);
+           closed[nClosed++] = f;
+         }
     }
   }
 
-  /* waiting for the termination of the intervening entities threads */
+  chunk[0].fileID = 0;                                                 /* empty chunk signaling the end of the work */
+  chunk[0].index = -1;
+  chunk[0].numBytes = 0;
+  chunk[0].overlap = 0;
+  putChunk (0, chunk[0], true);
+  free (res.patternCounts);
+  free (chunk);
+  free (fp);
+  free (nChunks);
+  free (closed);
+}
 
-  printf ("\nFinal report\n");
-  for (i = 0; i < nThreads; i++)
-  { if (pthread_join (tIdWorkers[i], (void *) &pStatus) != 0)                                       /* thread worker */
-       { perror ("error on waiting for thread customer");
-         exit (EXIT_FAILURE);
+/**
+ *  \brief Record the results of the files counted in a final checkpoint.
+ *
+ *  A run resumed from it counts only the files which could not be counted.
+ *
+ *  \param nFiles number of files
+ *  \param fileNames names of the files
+ */
+
+static void finalCheckpoint (int nFiles, char *fileNames[])
+{
+  TempResults res;
+
+  if (!checkpointing) return;
+  res.patternCounts = newPatternCounts ();
+  for (int f = 0; f < nFiles; f++)
+    if (getFileResults (0, f, &res)) checkpointFile (f, CKPT_DONE, fileSize (fileNames[f]), &res, NULL);
+  checkpointWrite (true);
+  free (res.patternCounts);
+}
+
+/**
+ *  \brief Count a range of each file of a list.
+ *
+ *  The ranges are answered from the chunk index of the files, when it is up to date.
+ *
+ *  \param nFiles number of files
+ *  \param fileNames names of the files
+ *  \param range range of each file to count
+ */
+
+static void processQueries (int nFiles, char *fileNames[], Range *range)
+{
+  FILE *report = (outFormat == OUT_TEXT) ? stdout : stderr;        /* keep machine readable output clean */
+  TempResults res;
+  bool indexed;
+
+  storeFileNames (0, nFiles, fileNames);
+  for (int f = 0; f < nFiles; f++)
+  { if (!countRange (fileNames[f], range, &res, &indexed))
+       { fprintf (stderr, "File %s doesn't exist\n", fileNames[f]);
+         saveFileResults (0, f, NULL);
+         continue;
        }
-    printf ("thread worker, with id %u, has terminated: ", i);
-    printf ("its status was %d\n", *pStatus);
+    if (verbose) fprintf (report, "%s: range counted %s\n", fileNames[f], indexed ? "from the index" : "by a scan");
+    saveFileResults (0, f, &res);
   }
-  printProcessingResults(0);
-  printf ("\nElapsed time = %.6f s\n", get_delta_time ());
+}
 
-  exit (EXIT_SUCCESS);
+/**
+ *  \brief Count a whole file.
+ *
+ *  When checkpoints are taken, the progress of the file is recorded every CKPTPERIOD seconds, and a file resumed
+ *  from a checkpoint is counted from where it was left. When chunks are sampled, the results of a large file are
+ *  estimated from a sample of its chunks instead.
+ *
+ *  \param fileID file identification
+ *  \param chunk chunk to read the file into
+ *  \param total returns the results of the file
+ *  \param slot trace slot of the calling thread
+ *
+ *  \return true if the file was counted, false if it could not be opened
+ */
+
+static bool countFile (int fileID, Chunk *chunk, TempResults *total, int slot)
+{
+  FILE *fp;
+  TempResults res;
+  bool endF;
+  ChunkIndex idx;                                                                  /* chunk index of the file */
+  int *counts = total->patternCounts;                                   /* occurrences of the patterns in the file */
+  off_t start = 0;                                                      /* bytes counted by an earlier run */
+  double last = 0.0;                                                               /* time of the last checkpoint */
+
+  if ((samplePrecision > 0.0) && (sampleFile (fileID, inFiles[fileID], chunk, total, slot) == SAMPLE_DONE))
+     return true;
+  if ((fp = fopen (inFiles[fileID], "rb")) == NULL)
+     { fprintf (stderr, "File %s doesn't exist\n", inFiles[fileID]);
+       return false;
+     }
+  chunk->fileID = fileID;
+  chunk->index = 0;
+  chunk->numBytes = 0;
+  memset (total, 0, sizeof (TempResults));
+  total->patternCounts = counts;
+  if (counts != NULL) memset (counts, 0, nPatterns * sizeof (int));
+  int state = checkpointRestore (fileID, &start, total, chunk);
+  if (state == CKPT_DONE)
+     { fclose (fp);
+       return true;
+     }
+  fseeko (fp, start, SEEK_SET);
+  bool indexing = buildIndex && (state == CKPT_PENDING);               /* an index must cover the whole file */
+  res.patternCounts = newPatternCounts ();
+  indexInit (&idx);
+  do
+  { double t = traceNow ();
+    off_t offset = ftello (fp);
+    endF = readChunk (fp, chunk);
+    traceEvent (slot, "read", t, fileID, chunk->index, chunk->numBytes);
+    t = traceNow ();
+    countChunk (chunk, &res);
+    traceEvent (slot, "count", t, fileID, chunk->index, chunk->numBytes);
+    total->nWords += res.nWords;
+    total->a += res.a;
+    total->e += res.e;
+    total->i += res.i;
+    total->o += res.o;
+    total->u += res.u;
+    total->c += res.c;
+    total->y += res.y;
+    total->nInvalid += res.nInvalid;
+    for (int p = 0; (counts != NULL) && (p < nPatterns); p++)
+      counts[p] += res.patternCounts[p];
+    if (indexing) indexAdd (&idx, offset, chunk, &res);
+    chunk->index += 1;
+    if (checkpointing && !endF && checkpointDue (&last))
+       { checkpointFile (fileID, CKPT_PARTIAL, ftello (fp), total, chunk);
+         checkpointWrite (false);
+       }
+  } while (!endF);
+  if (checkpointing)
+     { checkpointFile (fileID, CKPT_DONE, ftello (fp), total, NULL);
+       checkpointWrite (false);
+     }
+  fclose (fp);
+  free (res.patternCounts);
+  if (indexing) indexWrite (&idx, inFiles[fileID]);
+  indexFree (&idx);
+
+  return true;
 }
 
+/**
+ *  \brief Function file worker.
+ *
+ *  Its role is to simulate the life cycle of a worker which counts whole files.
+ *
+ *  \param par pointer to application defined worker identification
+ */
+
+static void *fileWorker (void *par)
+{
+  unsigned int id = *((unsigned int *) par);                    /* worker id */
+  Chunk *chunk = (Chunk *)malloc(sizeof(Chunk)); /* Chunk value */
+  TempResults res; /* results of a file */
+  int f; /* file id */
+
+  res.patternCounts = newPatternCounts();
+
+  while ((f = getNextFile(id)) != -1) /* take files until all files are taken */
+  {
+      double t = now(); /* start of the file */
+      saveFileResults(id, f, countFile(f, chunk, &res, id + 1) ? &res : NULL);
+      busyTime[id] += now() - t;
+  }
+  free(res.patternCounts);
+  free(chunk);
+  statusWorkers[id] = EXIT_SUCCESS;
+  pthread_exit (&statusWorkers[id]);
+}
 
 /**
  *  \brief Function worker.
@@ -228,12 +782,28 @@ static void *worker (void *par)
 
   Chunk *chunk = (Chunk *)malloc(sizeof(Chunk)); /* Chunk value */
   TempResults *res = (TempResults *)malloc(sizeof(TempResults)); /* TempResults value */
+  res->patternCounts = newPatternCounts(); /* occurrences of the patterns in a chunk */
 
+  double t = traceNow(); /* start of the current event */
   while (getChunk(id, chunk) != 1) /* get available data chunks until all chunks are processed */
   {
-      count(chunk, res); /* process data chunk */
+      if (chunk->numBytes > 0) traceFlow(id + 1, chunk->fileID, chunk->index, TRACE_GET);
+      traceEvent(id + 1, "getChunk", t, chunk->fileID, chunk->index, chunk->numBytes);
+      if (chunk->numBytes == 0) { t = traceNow(); continue; } /* chunk signaling the end of the work */
+      double b = now(); /* start of the work on the chunk */
+      t = traceNow();
+      countChunk(chunk, res); /* process data chunk */
+      traceEvent(id + 1, "count", t, chunk->fileID, chunk->index, chunk->numBytes);
+      t = traceNow();
       savePartialResults(id, res); /* save the partial results */
+      traceEvent(id + 1, "merge", t, chunk->fileID, chunk->index, chunk->numBytes);
+      busyTime[id] += now() - b;
+      t = traceNow();
   }
+  traceEvent(id + 1, "getChunk", t, -1, -1, 0); /* the one which finds no more chunks */
+  free(res->patternCounts);
+  free(res);
+  free(chunk);
   statusWorkers[id] = EXIT_SUCCESS;
   pthread_exit (&statusWorkers[id]);
 }
@@ -257,17 +827,43 @@ static double get_delta_time(void)
   return (double) (t1.tv_sec - t0.tv_sec) + 1.0e-9 * (double) (t1.tv_nsec - t0.tv_nsec);
 }
 
-// /**
-//  *  \brief Print command usage.
-//  *
-//  *  A message specifying how the program should be called is printed.
-//  *
-//  *  \param cmdName string with the name of the command
-//  */
-
-// static void printUsage (char *cmdName)
-// {
-//   fprintf (stderr, "\nSynopsis: %s [OPTIONS]\n"
-//            "  OPTIONS:\n"
-//            "  -t nThreads  --- set the number of threads to be created (default: 4)\n", cmdName);
-// }
\ No newline at end of file
+/**
+ *  \brief Print command usage.
+ *
+ *  A message specifying how the program should be called is printed.
+ *
+ *  \param cmdName string with the name of the command
+ */
+
+static void printUsage (char *cmdName)
+{
+  fprintf (stderr, "\nSynopsis: %s [OPTIONS] file...\n"
+           "  OPTIONS:\n"
+           "  -h           --- print this help\n"
+           "  -t nThreads  --- set the number of threads to be created (default: %d)\n"
+           "  -n           --- compose decomposed diacritics (NFC) before counting\n"
+           "  -f format    --- print the results of each file as soon as it is counted, as text, json (JSON\n"
+           "                   Lines) or csv (default: text)\n"
+           "  -p nProcs    --- split the files among nProcs worker processes (default: 1)\n"
+           "  -o shard     --- store the results in a binary shard\n"
+           "  -m           --- merge the results of the shards given in place of the files\n"
+           "  -x plan      --- execution plan: auto, seq, file, split or pipe (default: auto)\n"
+           "  -P r,s,d,c   --- count with a pipeline of r read, s split, d decode and c count threads (d may be 0:\n"
+           "                   the count threads then decode; default: 1,1,0,nThreads)\n"
+           "  -v           --- print the execution plan and the peak memory usage\n"
+           "  -T trace     --- store the chunk life cycle as a Chrome trace event (Perfetto) JSON file\n"
+           "  -i           --- store the chunk index of each file in file.idx (files are not split)\n"
+           "  -q range     --- count only a range of each file, bytes:start-end or lines:first-last, using the\n"
+           "                   chunk index when it is up to date\n"
+           "  -w patterns  --- count the occurrences of the words and phrases of a file, one per line\n"
+           "  -a           --- schedule the files in the order given (default: largest first, interleaving the\n"
+           "                   chunks of %d files)\n"
+           "  -c ckpt      --- store a checkpoint of the run every %d seconds\n"
+           "  -r           --- resume the run from its last checkpoint, if any (requires -c)\n"
+           "  -d dup       --- count repeated content once: files, for files with the same contents as an earlier\n"
+           "                   one, or chunks, for repeated chunks as well\n"
+           "  -s precision --- estimate the results of each file from a random sample of its chunks, until the\n"
+           "                   95%% confidence intervals are within +-precision (relative for the words, absolute for\n"
+           "                   the fraction of the words with each letter); files are not split\n",
+           cmdName, N, INTERLEAVE, CKPTPERIOD);
+}
@@ -0,0 +1,328 @@
+/**
+ *  \file patterns.c (implementation file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Multi-pattern search of a dictionary of words and phrases, with an Aho-Corasick automaton.
+ *
+ *  The code points of the patterns are mapped to a dense alphabet (one symbol per distinct letter of the
+ *  patterns, one for every other letter and one for a run of separators), and the automaton is stored as a
+ *  complete transition table, so the search costs a single table lookup per code point.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "countWords.h"
+#include "utf8.h"
+#include "patterns.h"
+
+/** \brief symbol of a run of separators */
+#define SPACE        0
+
+/** \brief symbol of a letter which is not part of any pattern */
+#define OTHER        1
+
+/** \brief code points below this limit are mapped to symbols through a table */
+#define MAXDIRECT    0x2100
+
+/** \brief flag signaling decomposed diacritics must be composed before counting */
+extern bool normalizeNFC;
+
+/** \brief number of patterns being searched */
+int nPatterns = 0;
+
+/** \brief patterns being searched, as given */
+char **patternNames = NULL;
+
+/** \brief symbol of each code point below MAXDIRECT (0 if it is not part of any pattern) */
+static unsigned short directSymbol[MAXDIRECT];
+
+/** \brief code points above MAXDIRECT which are part of some pattern */
+static int *extraCps;
+
+/** \brief number of code points above MAXDIRECT which are part of some pattern */
+static int nExtra;
+
+/** \brief number of symbols of the alphabet */
+static int nSymbols = 2;
+
+/** \brief transition table, nSymbols entries per state */
+static int *delta;
+
+/** \brief pattern recognized in each state, or -1 */
+static int *match;
+
+/** \brief next state, along the failure links, which recognizes a pattern (0 if none) */
+static int *dictLink;
+
+/** \brief length in bytes of the longest pattern */
+static int maxBytes = 0;
+
+/**
+ *  \brief Fold the case of a letter.
+ *
+ *  Internal operation.
+ *
+ *  \param cp code point
+ *
+ *  \return lower case code point
+ */
+
+static int foldCase (int cp)
+{
+  if ((cp >= 'A') && (cp <= 'Z')) return cp + 32;
+  if ((cp >= 0xC0) && (cp <= 0xDE) && (cp != 0xD7)) return cp + 32;
+  return cp;
+}
+
+/**
+ *  \brief Get the symbol of a code point.
+ *
+ *  The words are delimited as count() does: a separator, or an apostrophe before the first letter of a word, is
+ *  outside any word.
+ *
+ *  Internal operation.
+ *
+ *  \param cp code point
+ *  \param inWord flag signaling the previous code point is inside a word, updated
+ *  \param assign flag signaling a new symbol is assigned to a letter which has none
+ *
+ *  \return symbol
+ */
+
+static int symbolOf (int cp, bool *inWord, bool assign)
+{
+  int cls = charClass (cp);
+
+  if ((cls == SEPARATOR) || ((cls == JOINER) && !*inWord))
+     { *inWord = false;
+       return SPACE;
+     }
+  if (cls == LETTER) *inWord = true;
+  cp = foldCase (cp);
+  if (cp < MAXDIRECT)
+     { if ((directSymbol[cp] == 0) && assign) directSymbol[cp] = nSymbols++;
+       return (directSymbol[cp] == 0) ? OTHER : directSymbol[cp];
+     }
+  for (int k = 0; k < nExtra; k++)
+    if (extraCps[k] == cp) return MAXDIRECT + k;
+  if (!assign) return OTHER;
+  if ((extraCps = realloc (extraCps, (nExtra + 1) * sizeof (int))) == NULL)
+     { fprintf (stderr, "error on allocating space to the pattern alphabet\n");
+       exit (EXIT_FAILURE);
+     }
+  extraCps[nExtra] = cp;
+  return MAXDIRECT + nExtra++;
+}
+
+/**
+ *  \brief Load the patterns to search from a file, one per line, and build the automaton.
+ *
+ *  Empty lines and repeated patterns are skipped.
+ *
+ *  \param path name of the file
+ *
+ *  \return number of patterns
+ */
+
+int loadPatterns (const char *path)
+{
+  FILE *fp;
+  char line[4 * MAXPATTERN];
+  int cps[4 * MAXPATTERN];
+  int **seqs = NULL;                                                        /* symbols of each pattern */
+  int *lens = NULL;                                                 /* number of symbols of each pattern */
+  int nSeqs = 0;
+  int totalLen = 0;
+  int nInvalid;
+
+  if ((fp = fopen (path, "r")) == NULL)
+     { perror (path);
+       exit (EXIT_FAILURE);
+     }
+
+  /* first pass: the symbols of every pattern, with a separator run at both ends */
+
+  while (fgets (line, sizeof (line), fp) != NULL)
+  { int len = (int) strcspn (line, "\r\n");
+    line[len] = '\0';
+    if (len > MAXPATTERN)
+       { fprintf (stderr, "%s: pattern longer than %d bytes: %s\n", path, MAXPATTERN, line);
+         exit (EXIT_FAILURE);
+       }
+    int n = decodeChunk ((unsigned char *) line, len, cps, normalizeNFC, &nInvalid);
+    int *seq;
+    if (((seqs = realloc (seqs, (nSeqs + 1) * sizeof (int *))) == NULL) ||
+        ((lens = realloc (lens, (nSeqs + 1) * sizeof (int))) == NULL) ||
+        ((patternNames = realloc (patternNames, (nSeqs + 1) * sizeof (char *))) == NULL) ||
+        ((seq = malloc ((n + 2) * sizeof (int))) == NULL))
+       { fprintf (stderr, "error on allocating space to the patterns\n");
+         exit (EXIT_FAILURE);
+       }
+    int m = 0;
+    bool inWord = false;
+    seq[m++] = SPACE;
+    for (int p = 0; p < n; p++)
+    { int sym = symbolOf (cps[p], &inWord, true);
+      if ((sym != SPACE) || (seq[m - 1] != SPACE)) seq[m++] = sym;
+    }
+    if (seq[m - 1] != SPACE) seq[m++] = SPACE;
+    if (m <= 1)                                                                            /* empty pattern */
+       { free (seq);
+         continue;
+       }
+    seqs[nSeqs] = seq;
+    lens[nSeqs] = m;
+    patternNames[nSeqs] = strdup (line);
+    if (len > maxBytes) maxBytes = len;
+    totalLen += m;
+    nSeqs += 1;
+  }
+  fclose (fp);
+
+  /* second pass: the trie of the patterns */
+
+  int symbols = nSymbols + nExtra;                                   /* the extra symbols follow the direct ones */
+  for (int s = 0; s < nSeqs; s++)
+    for (int p = 0; p < lens[s]; p++)
+      if (seqs[s][p] >= MAXDIRECT) seqs[s][p] = nSymbols + (seqs[s][p] - MAXDIRECT);
+  int maxStates = totalLen + 1;
+  if (((delta = malloc ((size_t) maxStates * symbols * sizeof (int))) == NULL) ||
+      ((match = malloc (maxStates * sizeof (int))) == NULL) ||
+      ((dictLink = calloc (maxStates, sizeof (int))) == NULL))
+     { fprintf (stderr, "error on allocating space to the pattern automaton\n");
+       exit (EXIT_FAILURE);
+     }
+  memset (delta, -1, (size_t) maxStates * symbols * sizeof (int));
+  match[0] = -1;
+  int nStates = 1;
+  nPatterns = 0;
+  for (int s = 0; s < nSeqs; s++)
+  { int state = 0;
+    for (int p = 0; p < lens[s]; p++)
+    { int *next = &delta[(size_t) state * symbols + seqs[s][p]];
+      if (*next == -1)
+         { *next = nStates;
+           match[nStates++] = -1;
+         }
+      state = *next;
+    }
+    if (match[state] != -1)                                                             /* repeated pattern */
+       { fprintf (stderr, "%s: repeated pattern skipped: %s\n", path, patternNames[s]);
+         free (patternNames[s]);
+         continue;
+       }
+    match[state] = nPatterns;
+    patternNames[nPatterns++] = patternNames[s];
+  }
+
+  /* third pass: failure links folded into the transition table, in breadth first order */
+
+  int *fail, *queue;
+  int head = 0, tail = 0;
+  if (((fail = calloc (nStates, sizeof (int))) == NULL) || ((queue = malloc (nStates * sizeof (int))) == NULL))
+     { fprintf (stderr, "error on allocating space to the pattern automaton\n");
+       exit (EXIT_FAILURE);
+     }
+  for (int sym = 0; sym < symbols; sym++)
+  { int *next = &delta[sym];
+    if (*next == -1) *next = 0;
+    else queue[tail++] = *next;
+  }
+  while (head < tail)
+  { int u = queue[head++];
+    for (int sym = 0; sym < symbols; sym++)
+    { int *next = &delta[(size_t) u * symbols + sym];
+      int f = delta[(size_t) fail[u] * symbols + sym];
+      if (*next == -1) *next = f;
+      else { fail[*next] = f;
+             dictLink[*next] = (match[f] != -1) ? f : dictLink[f];
+             queue[tail++] = *next;
+           }
+    }
+  }
+  delta = realloc (delta, (size_t) nStates * symbols * sizeof (int));
+  nSymbols = symbols;
+
+  for (int s = 0; s < nSeqs; s++)
+    free (seqs[s]);
+  free (seqs);
+  free (lens);
+  free (fail);
+  free (queue);
+
+  return nPatterns;
+}
+
+/**
+ *  \brief Get the number of bytes of the previous chunk that must be repeated in front of each chunk, so that
+ *  patterns spanning a chunk boundary are found.
+ *
+ *  \return number of bytes of context
+ */
+
+int patternContext (void)
+{
+  return (nPatterns == 0) ? 0 : 2 * maxBytes + 16;
+}
+
+/**
+ *  \brief Allocate an array to store the number of occurrences of each pattern.
+ *
+ *  \return pointer to the array, or NULL if there are no patterns
+ */
+
+int *newPatternCounts (void)
+{
+  int *counts;
+
+  if (nPatterns == 0) return NULL;
+  if ((counts = calloc (nPatterns, sizeof (int))) == NULL)
+     { fprintf (stderr, "error on allocating space to the pattern counts\n");
+       exit (EXIT_FAILURE);
+     }
+  return counts;
+}
+
+/**
+ *  \brief Count the occurrences of the patterns in a chunk of code points.
+ *
+ *  Only the occurrences which end at or after the first code point of the chunk proper are counted; the code
+ *  points before it are the context repeated from the previous chunk, whose occurrences were already counted.
+ *
+ *  A chunk without context starts at a word boundary. The context may start inside a word, so no occurrence is
+ *  recognized before its first separator.
+ *
+ *  \param cps code points of the context and of the chunk
+ *  \param n number of code points
+ *  \param ownStart index of the first code point of the chunk proper
+ *  \param counts returns the number of occurrences of each pattern
+ */
+
+void searchPatterns (const int *cps, int n, int ownStart, int *counts)
+{
+  bool atBoundary = (ownStart == 0);                            /* the context may start inside a word */
+  int state = atBoundary ? delta[SPACE] : 0;
+  bool prevSpace = atBoundary;
+  bool inWord = !atBoundary;
+
+  memset (counts, 0, nPatterns * sizeof (int));
+  for (int p = 0; p <= n; p++)                                  /* a word boundary follows the chunk as well */
+  { int sym = (p < n) ? symbolOf (cps[p], &inWord, false) : SPACE;
+    if (sym >= MAXDIRECT) sym = nSymbols - nExtra + (sym - MAXDIRECT);
+    if (sym == SPACE)
+       { if (prevSpace) continue;                                  /* a run of separators is a single symbol */
+         prevSpace = true;
+       }
+    else prevSpace = false;
+    state = delta[(size_t) state * nSymbols + sym];
+    if (p < ownStart) continue;
+    for (int s = (match[state] != -1) ? state : dictLink[state]; s != 0; s = dictLink[s])
+      counts[match[s]] += 1;
+  }
+}
@@ -0,0 +1,66 @@
+/**
+ *  \file patterns.h (interface file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Multi-pattern search of a dictionary of words and phrases, with an Aho-Corasick automaton.
+ *
+ *  Matching follows the word splitting rules of count(): a pattern only matches whole words, every run of
+ *  separators in the text or in a pattern stands for a single word boundary, and letters are compared ignoring
+ *  case.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#ifndef PATTERNS_H
+#define PATTERNS_H
+
+/** \brief maximum number of bytes of a pattern */
+#define MAXPATTERN   256
+
+/** \brief number of patterns being searched */
+extern int nPatterns;
+
+/** \brief patterns being searched, as given */
+extern char **patternNames;
+
+/**
+ *  \brief Load the patterns to search from a file, one per line, and build the automaton.
+ *
+ *  Empty lines and repeated patterns are skipped.
+ *
+ *  \param path name of the file
+ *
+ *  \return number of patterns
+ */
+extern int loadPatterns (const char *path);
+
+/**
+ *  \brief Get the number of bytes of the previous chunk that must be repeated in front of each chunk, so that
+ *  patterns spanning a chunk boundary are found.
+ *
+ *  \return number of bytes of context
+ */
+extern int patternContext (void);
+
+/**
+ *  \brief Allocate an array to store the number of occurrences of each pattern.
+ *
+ *  \return pointer to the array, or NULL if there are no patterns
+ */
+extern int *newPatternCounts (void);
+
+/**
+ *  \brief Count the occurrences of the patterns in a chunk of code points.
+ *
+ *  Only the occurrences which end at or after the first code point of the chunk proper are counted; the code
+ *  points before it are the context repeated from the previous chunk, whose occurrences were already counted.
+ *
+ *  \param cps code points of the context and of the chunk
+ *  \param n number of code points
+ *  \param ownStart index of the first code point of the chunk proper
+ *  \param counts returns the number of occurrences of each pattern
+ */
+extern void searchPatterns (const int *cps, int n, int ownStart, int *counts);
+
+#endif /* PATTERNS_H */
@@ -0,0 +1,434 @@
+/**
+ *  \file pipeline.c (implementation file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Multi-stage pipeline: read, split, decode and count, each stage with its own pool of threads.
+ *
+ *  Every split thread owns a queue of blocks, and the blocks of a file always go to the queue of the same split
+ *  thread; since a file is read whole by a single read thread, its blocks are split in order.
+ *
+ *  Definition of the operations:
+ *     \li parseStages
+ *     \li runPipeline.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "probConst.h"
+#include "dataStructures.h"
+#include "sharedRegion.h"
+#include "chunkReader.h"
+#include "countWords.h"
+#include "patterns.h"
+#include "queue.h"
+#include "trace.h"
+#include "dedup.h"
+#include "pipeline.h"
+#include "utils.h"
+
+/** \brief main thread return status array */
+extern int* statusMain;
+
+/** \brief worker threads return status array */
+extern int* statusWorkers;
+
+/**
+ * \brief Struct to store a block of a file
+ */
+typedef struct
+{
+    int fileID;
+    int n;
+    bool last;
+    unsigned char bytes[BLOCKSIZE];
+} Block;
+
+/**
+ * \brief Struct to store the identification of a thread of the pipeline
+ */
+typedef struct
+{
+    unsigned int id;
+    int stage;
+    int index;
+} StageThread;
+
+/** \brief names of the stages */
+static const char *stageNames[NSTAGES] = { "read", "split", "decode", "count" };
+
+/** \brief names of the files */
+static char **names;
+
+/** \brief number of threads of each stage */
+static int nThreadsOf[NSTAGES];
+
+/** \brief queues of blocks, one per split thread */
+static Queue *blocks;
+
+/** \brief queue of chunks */
+static Queue chunks;
+
+/** \brief queue of decoded chunks */
+static Queue decoded;
+
+/** \brief splitter of each file being split */
+static Splitter **splitters;
+
+/** \brief number of chunks of each file being split */
+static int *nChunks;
+
+/** \brief time each thread spent working, in seconds */
+static double *busyTime;
+
+/** \brief number of items each thread produced */
+static long long *nItems;
+
+/**
+ *  \brief Parse the number of threads of each stage: read,split,decode,count.
+ *
+ *  Every stage but decode needs at least one thread; with no decode threads the chunks are decoded by the count
+ *  stage.
+ *
+ *  \param spec string to parse
+ *  \param threads returns the number of threads of each stage
+ *
+ *  \return true if the specification is valid
+ */
+
+bool parseStages (const char *spec, int *threads)
+{
+  int used;
+
+  if ((sscanf (spec, "%d,%d,%d,%d%n", &threads[STAGE_READ], &threads[STAGE_SPLIT], &threads[STAGE_DECODE],
+               &threads[STAGE_COUNT], &used) != 4) || (spec[used] != '\0'))
+     return false;
+  return (threads[STAGE_READ] > 0) && (threads[STAGE_SPLIT] > 0) && (threads[STAGE_DECODE] >= 0) &&
+         (threads[STAGE_COUNT] > 0);
+}
+
+/**
+ *  \brief Read stage: reads whole files in blocks.
+ *
+ *  \param id thread identification
+ */
+
+static void readStage (unsigned int id)
+{
+  Block *blk;
+  int f;
+
+  if ((blk = malloc (sizeof (Block))) == NULL)
+     { fprintf (stderr, "error on allocating space to a block\n");
+       exit (EXIT_FAILURE);
+     }
+  while ((f = getNextFile (id)) != -1)
+  { FILE *fp;
+    if ((fp = fopen (names[f], "rb")) == NULL)
+       { fprintf (stderr, "File %s doesn't exist\n", names[f]);
+         storeFileFailure (id, f);
+         continue;
+       }
+    blk->fileID = f;
+    do
+    { double t = now (), tr = traceNow ();
+      blk->n = (int) fread (blk->bytes, 1, BLOCKSIZE, fp);
+      blk->last = (blk->n < BLOCKSIZE);
+      traceEvent (id, "read", tr, f, -1, blk->n);
+      busyTime[id] += now () - t;
+      nItems[id] += 1;
+      queuePut (&blocks[f % nThreadsOf[STAGE_SPLIT]], id, blk);
+    } while (!blk->last);
+    fclose (fp);
+  }
+  for (int s = 0; s < nThreadsOf[STAGE_SPLIT]; s++)
+    queueClose (&blocks[s], id);
+  free (blk);
+}
+
+/**
+ *  \brief Split stage: splits the blocks of its files in chunks.
+ *
+ *  \param id thread identification
+ *  \param index index of the thread in its stage
+ */
+
+static void splitStage (unsigned int id, int index)
+{
+  Block *blk;
+
+  if ((blk = malloc (sizeof (Block))) == NULL)
+     { fprintf (stderr, "error on allocating space to a block\n");
+       exit (EXIT_FAILURE);
+     }
+  while (queueGet (&blocks[index], id, blk))
+  { int f = blk->fileID;
+    int pos = 0;                                                                       /* position in the block */
+    double t = now (), tr = traceNow ();
+
+    if (splitters[f] == NULL)                                                      /* first block of the file */
+       { if ((splitters[f] = malloc (sizeof (Splitter))) == NULL)
+            { fprintf (stderr, "error on allocating space to a splitter\n");
+              exit (EXIT_FAILURE);
+            }
+         splitterInit (splitters[f], f);
+         nChunks[f] = 0;
+       }
+    Chunk *chunk = &splitters[f]->chunk;
+    bool full;
+    while ((full = splitterNext (splitters[f], blk->bytes, blk->n, &pos, blk->last)) ||
+           (blk->last && (chunk->numBytes > chunk->overlap)))
+    { busyTime[id] += now () - t;
+      chunk->index = nChunks[f];
+      queuePut (&chunks, id, chunk);
+      traceFlow (id, f, chunk->index, TRACE_PUT);
+      t = now ();
+      nChunks[f] += 1;
+      nItems[id] += 1;
+      if (!full) break;                                                         /* last chunk of the file */
+    }
+    traceEvent (id, "split", tr, f, -1, blk->n);
+    busyTime[id] += now () - t;
+    if (blk->last)
+       { storeFileChunks (id, f, nChunks[f]);
+         free (splitters[f]);
+         splitters[f] = NULL;
+       }
+  }
+  queueClose (&chunks, id);
+  free (blk);
+}
+
+/**
+ *  \brief Decode stage: decodes and validates the chunks.
+ *
+ *  \param id thread identification
+ */
+
+static void decodeStage (unsigned int id)
+{
+  Chunk *chunk;
+  DecodedChunk *dec;
+  TempResults res;
+
+  if (((chunk = malloc (sizeof (Chunk))) == NULL) || ((dec = malloc (sizeof (DecodedChunk))) == NULL))
+     { fprintf (stderr, "error on allocating space to a chunk\n");
+       exit (EXIT_FAILURE);
+     }
+  res.patternCounts = newPatternCounts ();
+  while (queueGet (&chunks, id, chunk))
+  { double t = now (), tr = traceNow ();
+    traceFlow (id, chunk->fileID, chunk->index, TRACE_STEP);
+    dec->key = (dedupMode == DEDUP_CHUNKS) ? chunkKey (chunk) : 0;
+    if ((dedupMode == DEDUP_CHUNKS) && dedupFind (dec->key, chunk, &res))        /* a repeated chunk, not counted */
+       { savePartialResults (id, &res);
+         traceEvent (id, "decode", tr, chunk->fileID, chunk->index, chunk->numBytes);
+         busyTime[id] += now () - t;
+         continue;
+       }
+    decode (chunk, dec, nPatterns > 0);
+    if (dedupMode == DEDUP_CHUNKS)                                   /* the cache keeps the bytes of the chunk */
+       { dec->overlap = chunk->overlap;
+         memcpy (dec->textChunk, chunk->textChunk, chunk->numBytes);
+       }
+    traceEvent (id, "decode", tr, chunk->fileID, chunk->index, chunk->numBytes);
+    busyTime[id] += now () - t;
+    nItems[id] += 1;
+    queuePut (&decoded, id, dec);
+  }
+  queueClose (&decoded, id);
+  free (res.patternCounts);
+  free (chunk);
+  free (dec);
+}
+
+/**
+ *  \brief Count stage: counts the chunks, decoding them unless there is a decode stage.
+ *
+ *  \param id thread identification
+ */
+
+static void countStage (unsigned int id)
+{
+  Chunk *chunk;
+  DecodedChunk *dec;
+  TempResults res;
+
+  if (((chunk = malloc (sizeof (Chunk))) == NULL) || ((dec = malloc (sizeof (DecodedChunk))) == NULL))
+     { fprintf (stderr, "error on allocating space to a chunk\n");
+       exit (EXIT_FAILURE);
+     }
+  res.patternCounts = newPatternCounts ();
+  while ((nThreadsOf[STAGE_DECODE] > 0) ? queueGet (&decoded, id, dec) : queueGet (&chunks, id, chunk))
+  { double t = now (), tr = traceNow ();
+    int fileID, index, numBytes;                              /* of the chunk, whichever queue it came from */
+    if (nThreadsOf[STAGE_DECODE] == 0)
+       { fileID = chunk->fileID;
+         index = chunk->index;
+         numBytes = chunk->numBytes;
+         countChunk (chunk, &res);
+       }
+    else { fileID = dec->fileID;
+           index = dec->index;
+           numBytes = dec->numBytes;
+           countDecoded (dec, &res);
+           if (dedupMode != DEDUP_NONE)
+              dedupKeep (dec->key, dec->textChunk, dec->numBytes, dec->overlap, &res, now () - t);
+         }
+    traceFlow (id, fileID, index, TRACE_GET);
+    traceEvent (id, "count", tr, fileID, index, numBytes);
+    tr = traceNow ();
+    savePartialResults (id, &res);
+    traceEvent (id, "merge", tr, fileID, index, numBytes);
+    busyTime[id] += now () - t;
+    nItems[id] += 1;
+  }
+  free (res.patternCounts);
+  free (chunk);
+  free (dec);
+}
+
+/**
+ *  \brief Life cycle of a thread of the pipeline.
+ *
+ *  \param par pointer to the identification of the thread
+ */
+
+static void *stageThread (void *par)
+{
+  StageThread *th = (StageThread *) par;
+
+  switch (th->stage)
+  { case STAGE_READ:   readStage (th->id);
+                       break;
+    case STAGE_SPLIT:  splitStage (th->id, th->index);
+                       break;
+    case STAGE_DECODE: decodeStage (th->id);
+                       break;
+    default:           countStage (th->id);
+  }
+  statusWorkers[th->id] = EXIT_SUCCESS;
+  pthread_exit (&statusWorkers[th->id]);
+}
+
+/**
+ *  \brief Print the statistics of a queue.
+ *
+ *  Internal operation.
+ *
+ *  \param report stream to print to
+ *  \param q queue
+ */
+
+static void printQueue (FILE *report, Queue *q)
+{
+  fprintf (report, "Queue %-7s: capacity %d (from %d, at most %d), %lld items, %lld producer waits, "
+           "%lld consumer waits\n", q->name, q->capacity, q->initCapacity, q->maxCapacity, q->nItems,
+           q->totalFullWaits, q->totalEmptyWaits);
+}
+
+/**
+ *  \brief Count a list of files with the pipeline.
+ *
+ *  The files are read in the order stored in the shared region. The results are left in the shared region.
+ *  Every thread, numbered from 1 (0 is the main thread), has its own return status, so the return status arrays
+ *  must have room for the threads of every stage.
+ *
+ *  \param nFiles number of files
+ *  \param fileNames names of the files
+ *  \param threads number of threads of each stage
+ *  \param report stream to print the statistics of the stages and queues to (NULL for none)
+ */
+
+void runPipeline (int nFiles, char *fileNames[], const int *threads, FILE *report)
+{
+  int total = 0;                                                                        /* number of threads */
+  pthread_t *tId;                                                                  /* internal thread id array */
+  StageThread *th;                                                        /* application defined thread id array */
+  int *pStatus;                                                                       /* pointer to execution status */
+
+  names = fileNames;
+  for (int s = 0; s < NSTAGES; s++)
+  { nThreadsOf[s] = threads[s];
+    total += threads[s];
+  }
+
+  if (((tId = malloc (total * sizeof (pthread_t))) == NULL) ||
+      ((th = malloc (total * sizeof (StageThread))) == NULL) ||
+      ((busyTime = calloc (total + 1, sizeof (double))) == NULL) ||
+      ((nItems = calloc (total + 1, sizeof (long long))) == NULL) ||
+      ((splitters = calloc (nFiles + 1, sizeof (Splitter *))) == NULL) ||
+      ((nChunks = calloc (nFiles + 1, sizeof (int))) == NULL) ||
+      ((blocks = malloc (threads[STAGE_SPLIT] * sizeof (Queue))) == NULL))
+     { fprintf (stderr, "error on allocating space to the pipeline\n");
+       exit (EXIT_FAILURE);
+     }
+
+  /* queues sized from the number of consumers, free to grow up to the capacity of the data transfer region */
+
+  int chunkConsumers = (threads[STAGE_DECODE] > 0) ? threads[STAGE_DECODE] : threads[STAGE_COUNT];
+  for (int s = 0; s < threads[STAGE_SPLIT]; s++)
+    queueInit (&blocks[s], "blocks", sizeof (Block), 2, K / threads[STAGE_SPLIT] + 2, threads[STAGE_READ]);
+  queueInit (&chunks, "chunks", sizeof (Chunk), 2 * chunkConsumers, K, threads[STAGE_SPLIT]);
+  if (threads[STAGE_DECODE] > 0)
+     queueInit (&decoded, "decoded", sizeof (DecodedChunk), 2 * threads[STAGE_COUNT], K, threads[STAGE_DECODE]);
+
+  /* generation of the threads of every stage */
+
+  int n = 0;
+  for (int s = 0; s < NSTAGES; s++)
+    for (int k = 0; k < threads[s]; k++, n++)
+    { th[n].id = n + 1;
+      th[n].stage = s;
+      th[n].index = k;
+      traceName (th[n].id, stageNames[s], k);
+      if (pthread_create (&tId[n], NULL, stageThread, &th[n]) != 0)
+         { perror ("error on creating a pipeline thread");
+           exit (EXIT_FAILURE);
+         }
+    }
+
+  /* waiting for the termination of the threads */
+
+  for (n = 0; n < total; n++)
+    if ((pthread_join (tId[n], (void *) &pStatus) != 0) || (*pStatus != EXIT_SUCCESS))
+       { fprintf (stderr, "%s thread %d has failed\n", stageNames[th[n].stage], th[n].index);
+         exit (EXIT_FAILURE);
+       }
+
+  if (report != NULL)                                                       /* where the time of each stage goes */
+     { for (int s = 0, id = 1; s < NSTAGES; s++)
+       { double busy = 0.0;
+         long long items = 0;
+         for (int k = 0; k < threads[s]; k++, id++)
+         { busy += busyTime[id];
+           items += nItems[id];
+         }
+         if (threads[s] == 0) continue;
+         fprintf (report, "Stage %-6s: %d threads, %lld items, busy %.6f s per thread\n", stageNames[s],
+                  threads[s], items, busy / threads[s]);
+       }
+       for (int s = 0; s < threads[STAGE_SPLIT]; s++)
+         printQueue (report, &blocks[s]);
+       printQueue (report, &chunks);
+       if (threads[STAGE_DECODE] > 0) printQueue (report, &decoded);
+     }
+
+  for (int s = 0; s < threads[STAGE_SPLIT]; s++)
+    queueDestroy (&blocks[s]);
+  queueDestroy (&chunks);
+  if (threads[STAGE_DECODE] > 0) queueDestroy (&decoded);
+  free (blocks);
+  free (splitters);
+  free (nChunks);
+  free (busyTime);
+  free (nItems);
+  free (tId);
+  free (th);
+}
@@ -0,0 +1,65 @@
+/**
+ *  \file pipeline.h (interface file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Multi-stage pipeline: the files are read in blocks, the blocks are split in chunks, the chunks are optionally
+ *  decoded (and validated) by a stage of their own, and counted. Each stage has its own pool of threads, and
+ *  consecutive stages are connected by bounded queues which size themselves from the observed throughput of the
+ *  stages (see queue.h), so that a slow stage can be given more threads without changing the others.
+ *
+ *  The blocks of a file are always split by the same thread, in order, so that the chunks are exactly those of the
+ *  other execution plans.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/** \brief stage reading the files in blocks */
+#define STAGE_READ     0
+
+/** \brief stage splitting the blocks in chunks */
+#define STAGE_SPLIT    1
+
+/** \brief stage decoding and validating the chunks (optional) */
+#define STAGE_DECODE   2
+
+/** \brief stage counting the chunks */
+#define STAGE_COUNT    3
+
+/** \brief number of stages */
+#define NSTAGES        4
+
+/**
+ *  \brief Parse the number of threads of each stage: read,split,decode,count.
+ *
+ *  Every stage but decode needs at least one thread; with no decode threads the chunks are decoded by the count
+ *  stage.
+ *
+ *  \param spec string to parse
+ *  \param threads returns the number of threads of each stage
+ *
+ *  \return true if the specification is valid
+ */
+extern bool parseStages (const char *spec, int *threads);
+
+/**
+ *  \brief Count a list of files with the pipeline.
+ *
+ *  The files are read in the order stored in the shared region. The results are left in the shared region.
+ *  Every thread, numbered from 1 (0 is the main thread), has its own return status, so the return status arrays
+ *  must have room for the threads of every stage.
+ *
+ *  \param nFiles number of files
+ *  \param fileNames names of the files
+ *  \param threads number of threads of each stage
+ *  \param report stream to print the statistics of the stages and queues to (NULL for none)
+ */
+extern void runPipeline (int nFiles, char *fileNames[], const int *threads, FILE *report);
+
+#endif /* PIPELINE_H */
@@ -0,0 +1,160 @@
+/**
+ *  \file planner.c (implementation file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Choice of the execution plan from the size of the input and the available cores.
+ *
+ *  Definition of the operations:
+ *     \li fileSize
+ *     \li largestFirst
+ *     \li choosePlan
+ *     \li printPlan.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "probConst.h"
+#include "planner.h"
+
+/**
+ *  \brief Get the size of a file.
+ *
+ *  \param fileName name of the file
+ *
+ *  \return size of the file in bytes, or 0 if it can not be accessed
+ */
+
+off_t fileSize (const char *fileName)
+{
+  struct stat st;
+
+  return (stat (fileName, &st) == 0) ? st.st_size : 0;
+}
+
+/** \brief size of each file being ordered */
+static off_t *sizes;
+
+/**
+ *  \brief Compare two files by decreasing size, and then by increasing identification.
+ *
+ *  Internal operation.
+ *
+ *  \param a pointer to the identification of the first file
+ *  \param b pointer to the identification of the second file
+ *
+ *  \return negative, zero or positive if the first file goes before, with or after the second one
+ */
+
+static int bySize (const void *a, const void *b)
+{
+  int fa = *(const int *) a, fb = *(const int *) b;
+
+  if (sizes[fa] != sizes[fb]) return (sizes[fa] > sizes[fb]) ? -1 : 1;
+  return fa - fb;
+}
+
+/**
+ *  \brief Order a list of files from the largest to the smallest.
+ *
+ *  Files of the same size keep their relative order.
+ *
+ *  \param nFiles number of files
+ *  \param fileNames names of the files
+ *
+ *  \return array with the identifications of the files, largest first (to be freed by the caller)
+ */
+
+int *largestFirst (int nFiles, char *fileNames[])
+{
+  int *order;
+
+  if (((order = malloc ((nFiles + 1) * sizeof (int))) == NULL) ||
+      ((sizes = malloc ((nFiles + 1) * sizeof (off_t))) == NULL))
+     { fprintf (stderr, "error on allocating space to the file order\n");
+       exit (EXIT_FAILURE);
+     }
+  for (int f = 0; f < nFiles; f++)
+  { order[f] = f;
+    sizes[f] = fileSize (fileNames[f]);
+  }
+  qsort (order, nFiles, sizeof (int), bySize);
+  free (sizes);
+
+  return order;
+}
+
+/**
+ *  \brief Choose the execution plan of a list of files.
+ *
+ *  Small inputs are counted sequentially, many files of similar size are counted whole by each worker thread, and
+ *  the remaining inputs are split in chunks.
+ *
+ *  \param nFiles number of files
+ *  \param fileNames names of the files
+ *  \param maxThreads maximum number of worker threads
+ *  \param requested plan requested by the user (PLAN_AUTO to let the planner choose)
+ *  \param wholeFiles flag signaling the files must not be split (e.g. to index them)
+ *
+ *  \return execution plan
+ */
+
+Plan choosePlan (int nFiles, char *fileNames[], int maxThreads, int requested, bool wholeFiles)
+{
+  Plan plan;
+  long cores = sysconf (_SC_NPROCESSORS_ONLN);
+
+  plan.nFiles = nFiles;
+  plan.nCores = (cores > 0) ? (int) cores : 1;
+  plan.totalBytes = plan.largestBytes = 0;
+  for (int f = 0; f < nFiles; f++)
+  { off_t size = fileSize (fileNames[f]);
+    plan.totalBytes += size;
+    if (size > plan.largestBytes) plan.largestBytes = size;
+  }
+
+  int workers = (maxThreads < plan.nCores) ? maxThreads : plan.nCores;        /* threads which can run at once */
+  off_t nChunks = plan.totalBytes / CHUNKSIZE + 1;                                /* approximate number of chunks */
+
+  if (requested != PLAN_AUTO) plan.kind = requested;
+  else if ((workers <= 1) || (plan.totalBytes < SEQLIMIT)) plan.kind = PLAN_SEQUENTIAL;
+  else if ((nFiles >= PERFILEMIN * workers) && (plan.largestBytes * workers <= plan.totalBytes))
+          plan.kind = PLAN_PER_FILE;                               /* no file would keep a worker busy alone */
+  else plan.kind = PLAN_SPLIT;
+  if (wholeFiles && ((plan.kind == PLAN_SPLIT) || (plan.kind == PLAN_PIPELINE))) plan.kind = PLAN_PER_FILE;
+
+  switch (plan.kind)
+  { case PLAN_SEQUENTIAL: plan.nWorkers = 0;
+                          break;
+    case PLAN_PER_FILE:   plan.nWorkers = (maxThreads < nFiles) ? maxThreads : nFiles;
+                          break;
+    default:              plan.nWorkers = (maxThreads < nChunks) ? maxThreads : (int) nChunks;
+  }
+  if ((plan.kind != PLAN_SEQUENTIAL) && (plan.nWorkers < 1)) plan.nWorkers = 1;
+
+  return plan;
+}
+
+/**
+ *  \brief Print an execution plan.
+ *
+ *  \param fp stream to print to
+ *  \param plan execution plan
+ */
+
+void printPlan (FILE *fp, Plan *plan)
+{
+  static const char *names[] = { "auto", "sequential", "per file", "split files", "pipeline" };
+
+  fprintf (fp, "Execution plan: %s", names[plan->kind]);
+  if (plan->kind != PLAN_SEQUENTIAL) fprintf (fp, " with %d worker threads", plan->nWorkers);
+  fprintf (fp, " (%d files, %lld bytes, largest %lld bytes, %d cores)\n", plan->nFiles,
+           (long long) plan->totalBytes, (long long) plan->largestBytes, plan->nCores);
+}
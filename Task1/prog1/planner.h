@@ -0,0 +1,91 @@
+/**
+ *  \file planner.h (interface file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Choice of the execution plan from the size of the input and the available cores.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+/** \brief plan chosen from the input (only valid as a requested plan) */
+#define PLAN_AUTO         0
+
+/** \brief files counted inline by the main thread: no data transfer region and no worker threads */
+#define PLAN_SEQUENTIAL   1
+
+/** \brief each worker thread counts whole files */
+#define PLAN_PER_FILE     2
+
+/** \brief files split in chunks by the main thread and counted by the worker threads */
+#define PLAN_SPLIT        3
+
+/** \brief files read, split, decoded and counted by a pipeline of stages, each with its own threads */
+#define PLAN_PIPELINE     4
+
+/**
+ * \brief Struct to store an execution plan
+ */
+typedef struct
+{
+    int kind;
+    int nWorkers;
+    int nFiles;
+    off_t totalBytes;
+    off_t largestBytes;
+    int nCores;
+} Plan;
+
+/**
+ *  \brief Get the size of a file.
+ *
+ *  \param fileName name of the file
+ *
+ *  \return size of the file in bytes, or 0 if it can not be accessed
+ */
+extern off_t fileSize (const char *fileName);
+
+/**
+ *  \brief Order a list of files from the largest to the smallest.
+ *
+ *  Files of the same size keep their relative order.
+ *
+ *  \param nFiles number of files
+ *  \param fileNames names of the files
+ *
+ *  \return array with the identifications of the files, largest first (to be freed by the caller)
+ */
+extern int *largestFirst (int nFiles, char *fileNames[]);
+
+/**
+ *  \brief Choose the execution plan of a list of files.
+ *
+ *  Small inputs are counted sequentially, many files of similar size are counted whole by each worker thread, and
+ *  the remaining inputs are split in chunks.
+ *
+ *  \param nFiles number of files
+ *  \param fileNames names of the files
+ *  \param maxThreads maximum number of worker threads
+ *  \param requested plan requested by the user (PLAN_AUTO to let the planner choose)
+ *  \param wholeFiles flag signaling the files must not be split (e.g. to index them)
+ *
+ *  \return execution plan
+ */
+extern Plan choosePlan (int nFiles, char *fileNames[], int maxThreads, int requested, bool wholeFiles);
+
+/**
+ *  \brief Print an execution plan.
+ *
+ *  \param fp stream to print to
+ *  \param plan execution plan
+ */
+extern void printPlan (FILE *fp, Plan *plan);
+
+#endif /* PLANNER_H */
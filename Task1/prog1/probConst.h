@@ -19,5 +19,38 @@
 /** \brief maximum capacity of the data transfer region (in number of values that can be stored) */
 #define  K           100
 
+/** \brief number of bytes after which a chunk is closed at the next word boundary */
+#define  CHUNKSIZE   4096
+
+/** \brief maximum number of bytes of a chunk */
+#define  MAXCHUNK    6000
+
+/** \brief total number of bytes under which the files are counted sequentially */
+#define  SEQLIMIT    (1 << 20)
+
+/** \brief minimum number of files per worker thread for the files to be counted whole */
+#define  PERFILEMIN  4
+
+/** \brief number of files whose chunks are interleaved by the producer */
+#define  INTERLEAVE  4
+
+/** \brief minimum number of seconds between checkpoints */
+#define  CKPTPERIOD  5
+
+/** \brief number of bytes read at a time by the read stage of the pipeline */
+#define  BLOCKSIZE   (1 << 16)
+
+/** \brief number of chunks kept in the cache of chunk results */
+#define  DEDUPSLOTS  (1 << 12)
+
+/** \brief number of strata each file is divided in, when its chunks are sampled */
+#define  STRATA      16
+
+/** \brief minimum number of chunks sampled from each stratum before the precision is checked */
+#define  MINROUNDS   3
+
+/** \brief files smaller than this number of bytes are counted whole, even when chunks are sampled */
+#define  SAMPLEMIN   (1 << 20)
+
 
 #endif /* PROBCONST_H_ */
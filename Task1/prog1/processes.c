@@ -0,0 +1,177 @@
+/**
+ *  \file processes.c (implementation file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Multi-process execution: a coordinator partitions the files among worker processes, which return their
+ *  results through POSIX shared memory.
+ *
+ *  Each file owns a slot of the shared memory segment, written only by the process the file was assigned to,
+ *  and read by the coordinator after that process terminated.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "dataStructures.h"
+#include "sharedRegion.h"
+#include "processes.h"
+#include "planner.h"
+
+/** \brief output format of the results */
+extern int outFormat;
+
+/** \brief file not processed yet */
+#define PENDING      0
+
+/** \brief file processed */
+#define DONE         1
+
+/** \brief file which could not be processed */
+#define FAILED       2
+
+/**
+ *  \brief Struct to store the results of a file in shared memory
+ */
+typedef struct
+{
+  TempResults res;
+  int state;
+} Slot;
+
+/**
+ *  \brief Count a list of files with several worker processes.
+ *
+ *  The files are partitioned by size among the processes (largest first, to the least loaded process). The
+ *  results of each process are stored in the shared region as soon as it terminates; the files of a process that
+ *  crashed are signaled as not processed, while the remaining ones are not affected.
+ *
+ *  \param nProcs number of worker processes
+ *  \param nFiles number of files
+ *  \param fileNames names of the files
+ *  \param process routine run by each worker process on its part of the files
+ *
+ *  \return number of worker processes which failed
+ */
+
+int runProcesses (int nProcs, int nFiles, char *fileNames[], FilesProcessor process)
+{
+  int *order;                                                                    /* files from the largest one */
+  off_t *load;                                                                  /* bytes assigned to each process */
+  int *owner;                                                                    /* process each file is assigned to */
+  pid_t *pid;                                                                        /* pid of each process */
+  char **names;                                                                /* files of a process, in order */
+  int f, p;
+
+  if (((load = calloc (nProcs, sizeof (off_t))) == NULL) ||
+      ((owner = malloc (nFiles * sizeof (int))) == NULL) || ((pid = malloc (nProcs * sizeof (pid_t))) == NULL) ||
+      ((names = malloc ((nFiles + 1) * sizeof (char *))) == NULL))
+     { fprintf (stderr, "error on allocating space to the worker processes\n");
+       exit (EXIT_FAILURE);
+     }
+
+  /* partition of the files: the largest unassigned file goes to the least loaded process */
+
+  order = largestFirst (nFiles, fileNames);
+  for (int n = 0; n < nFiles; n++)
+  { int least = 0;
+    for (p = 1; p < nProcs; p++)
+      if (load[p] < load[least]) least = p;
+    owner[order[n]] = least;
+    load[least] += fileSize (fileNames[order[n]]);
+  }
+  free (order);
+
+  /* shared memory segment with one slot per file */
+
+  char shmName[32];
+  int fd;
+  Slot *slots;
+
+  sprintf (shmName, "/cle-%d", (int) getpid ());
+  if ((fd = shm_open (shmName, O_CREAT | O_EXCL | O_RDWR, 0600)) == -1)
+     { perror ("error on creating the shared memory segment");
+       exit (EXIT_FAILURE);
+     }
+  if ((ftruncate (fd, nFiles * sizeof (Slot)) != 0) ||
+      ((slots = mmap (NULL, nFiles * sizeof (Slot), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED))
+     { perror ("error on mapping the shared memory segment");
+       shm_unlink (shmName);
+       exit (EXIT_FAILURE);
+     }
+  close (fd);
+
+  /* generation of the worker processes */
+
+  fflush (stdout);
+  fflush (stderr);
+  for (p = 0; p < nProcs; p++)
+  { if ((pid[p] = fork ()) == -1)
+       { perror ("error on creating worker process");
+         shm_unlink (shmName);
+         exit (EXIT_FAILURE);
+       }
+    if (pid[p] == 0)                                                                        /* worker process */
+       { int n = 0;
+         for (f = 0; f < nFiles; f++)
+           if (owner[f] == p) names[n++] = fileNames[f];
+         outFormat = OUT_NONE;                                            /* the coordinator prints the results */
+         if (n > 0) process (n, names);
+         n = 0;
+         for (f = 0; f < nFiles; f++)
+           if (owner[f] == p)
+              { slots[f].state = getFileResults (0, n++, &slots[f].res) ? DONE : FAILED;
+                slots[f].res.fileID = f;
+              }
+         _exit (EXIT_SUCCESS);
+       }
+  }
+  shm_unlink (shmName);                                   /* the segment lives on while it is mapped */
+
+  /* gathering of the results as each worker process terminates */
+
+  int nFailed = 0;
+  int status;
+
+  storeFileNames (0, nFiles, fileNames);
+  for (int n = 0; n < nProcs; n++)
+  { pid_t done;
+    if ((done = wait (&status)) == -1)
+       { perror ("error on waiting for worker process");
+         exit (EXIT_FAILURE);
+       }
+    for (p = 0; (p < nProcs) && (pid[p] != done); p++) ;
+    if (p == nProcs) { n--; continue; }
+    bool ok = WIFEXITED (status) && (WEXITSTATUS (status) == EXIT_SUCCESS);
+    if (!ok)
+       { if (WIFSIGNALED (status))
+            fprintf (stderr, "worker process %d was terminated by signal %d\n", p, WTERMSIG (status));
+         else fprintf (stderr, "worker process %d has failed\n", p);
+         nFailed += 1;
+       }
+    for (f = 0; f < nFiles; f++)
+      if (owner[f] == p)
+         { if (ok && (slots[f].state == DONE))
+              { savePartialResults (0, &slots[f].res);
+                storeFileChunks (0, f, 1);
+              }
+           else storeFileFailure (0, f);
+         }
+  }
+
+  munmap (slots, nFiles * sizeof (Slot));
+  free (load);
+  free (owner);
+  free (pid);
+  free (names);
+
+  return nFailed;
+}
@@ -0,0 +1,34 @@
+/**
+ *  \file processes.h (interface file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Multi-process execution: a coordinator partitions the files among worker processes, which return their
+ *  results through POSIX shared memory.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#ifndef PROCESSES_H
+#define PROCESSES_H
+
+/** \brief routine which counts a list of files, leaving the results in the shared region */
+typedef void (*FilesProcessor) (int nFiles, char *fileNames[]);
+
+/**
+ *  \brief Count a list of files with several worker processes.
+ *
+ *  The files are partitioned by size among the processes (largest first, to the least loaded process). The
+ *  results of each process are stored in the shared region as soon as it terminates; the files of a process that
+ *  crashed are signaled as not processed, while the remaining ones are not affected.
+ *
+ *  \param nProcs number of worker processes
+ *  \param nFiles number of files
+ *  \param fileNames names of the files
+ *  \param process routine run by each worker process on its part of the files
+ *
+ *  \return number of worker processes which failed
+ */
+extern int runProcesses (int nProcs, int nFiles, char *fileNames[], FilesProcessor process);
+
+#endif /* PROCESSES_H */
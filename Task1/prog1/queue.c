@@ -0,0 +1,262 @@
+/**
+ *  \file queue.c (implementation file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Synchronization based on monitors.
+ *  Both threads and the monitor are implemented using the pthread library which enables the creation of a
+ *  monitor of the Lampson / Redell type.
+ *
+ *  Bounded queues between the stages of a pipeline, each one implemented as a monitor of its own. The identification
+ *  of a producer or consumer is also its trace slot, where the time it waits on a full or empty queue is recorded.
+ *
+ *  Definition of the operations carried out by the producers / consumers:
+ *     \li queueInit
+ *     \li queuePut
+ *     \li queueGet
+ *     \li queueClose
+ *     \li queueDestroy.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <errno.h>
+
+#include "queue.h"
+#include "trace.h"
+
+/** \brief producer threads return status array */
+extern int* statusMain;
+
+/** \brief worker threads return status array */
+extern int* statusWorkers;
+
+/**
+ *  \brief Enter the monitor of a queue.
+ *
+ *  Internal monitor operation.
+ *
+ *  \param q queue
+ *  \param status return status of the calling thread
+ */
+
+static void enter (Queue *q, int *status)
+{
+  if ((*status = pthread_mutex_lock (&q->accessCR)) != 0)                                          /* enter monitor */
+     { errno = *status;                                                                       /* save error in errno */
+       perror ("error on entering monitor(CF)");
+       *status = EXIT_FAILURE;
+       pthread_exit (status);
+     }
+}
+
+/**
+ *  \brief Exit the monitor of a queue.
+ *
+ *  Internal monitor operation.
+ *
+ *  \param q queue
+ *  \param status return status of the calling thread
+ */
+
+static void leave (Queue *q, int *status)
+{
+  if ((*status = pthread_mutex_unlock (&q->accessCR)) != 0)                                         /* exit monitor */
+     { errno = *status;                                                                       /* save error in errno */
+       perror ("error on exiting monitor(CF)");
+       *status = EXIT_FAILURE;
+       pthread_exit (status);
+     }
+}
+
+/**
+ *  \brief Wake up the threads waiting on a synchronization point.
+ *
+ *  Internal monitor operation.
+ *
+ *  \param cond synchronization point
+ *  \param all flag signaling every thread must be woken up, instead of a single one
+ *  \param status return status of the calling thread
+ */
+
+static void wakeUp (pthread_cond_t *cond, bool all, int *status)
+{
+  if ((*status = (all ? pthread_cond_broadcast (cond) : pthread_cond_signal (cond))) != 0)
+     { errno = *status;                                                                       /* save error in errno */
+       perror ("error on signaling a queue");
+       *status = EXIT_FAILURE;
+       pthread_exit (status);
+     }
+}
+
+/**
+ *  \brief Account an operation on a queue, growing it at the end of a window in which both its producers and its
+ *  consumers had to wait.
+ *
+ *  Internal monitor operation.
+ *
+ *  \param q queue
+ */
+
+static void adapt (Queue *q)
+{
+  unsigned char *mem;
+
+  if (++q->windowOps < 4 * q->capacity) return;
+  if ((q->fullWaits > 0) && (q->emptyWaits > 0) && (q->capacity < q->maxCapacity) &&
+      ((mem = malloc (2 * q->capacity * q->itemSize)) != NULL))             /* unwind the ring in the new region */
+     { for (int k = 0; k < q->count; k++)
+         memcpy (mem + k * q->itemSize, q->mem + ((q->ri + k) % q->capacity) * q->itemSize, q->itemSize);
+       free (q->mem);
+       q->mem = mem;
+       q->ri = 0;
+       q->capacity *= 2;
+       if (q->capacity > q->maxCapacity) q->capacity = q->maxCapacity;
+     }
+  q->windowOps = q->fullWaits = q->emptyWaits = 0;
+}
+
+/**
+ *  \brief Initialize an empty queue.
+ *
+ *  \param q queue
+ *  \param name name of the queue
+ *  \param itemSize number of bytes of an item
+ *  \param capacity initial number of items that can be stored
+ *  \param maxCapacity largest number of items that can be stored
+ *  \param nProducers number of producers, each of which closes the queue when done
+ */
+
+void queueInit (Queue *q, const char *name, size_t itemSize, int capacity, int maxCapacity, int nProducers)
+{
+  memset (q, 0, sizeof (Queue));
+  q->name = name;
+  q->itemSize = itemSize;
+  q->capacity = q->initCapacity = capacity;
+  q->maxCapacity = (maxCapacity > capacity) ? maxCapacity : capacity;
+  q->nProducers = nProducers;
+  if ((q->mem = malloc (capacity * itemSize)) == NULL)
+     { fprintf (stderr, "error on allocating space to the queue %s\n", name);
+       exit (EXIT_FAILURE);
+     }
+  pthread_mutex_init (&q->accessCR, NULL);
+  pthread_cond_init (&q->notFull, NULL);                                /* initialize producers synchronization point */
+  pthread_cond_init (&q->notEmpty, NULL);                               /* initialize consumers synchronization point */
+}
+
+/**
+ *  \brief Store an item in a queue, waiting while it is full.
+ *
+ *  \param q queue
+ *  \param prodId producer identification
+ *  \param item item to be copied into the queue
+ */
+
+void queuePut (Queue *q, unsigned int prodId, const void *item)
+{
+  bool waited = false;                                                     /* whether the queue was full */
+  double t = 0.0;                                                                          /* start of the wait */
+
+  enter (q, &statusMain[prodId]);
+  if (q->count == q->capacity)
+     { q->fullWaits += 1;
+       q->totalFullWaits += 1;
+       waited = true;
+       t = traceNow ();
+     }
+  while (q->count == q->capacity)                                                 /* wait if the queue is full */
+  { if ((statusMain[prodId] = pthread_cond_wait (&q->notFull, &q->accessCR)) != 0)
+       { errno = statusMain[prodId];                                                          /* save error in errno */
+         perror ("error on waiting in notFull");
+         statusMain[prodId] = EXIT_FAILURE;
+         pthread_exit (&statusMain[prodId]);
+       }
+  }
+  if (waited) traceEvent (prodId, "waitPut", t, -1, -1, 0);
+  memcpy (q->mem + ((q->ri + q->count) % q->capacity) * q->itemSize, item, q->itemSize);
+  q->count += 1;
+  q->nItems += 1;
+  adapt (q);
+  wakeUp (&q->notEmpty, false, &statusMain[prodId]);                         /* let a consumer know of the item */
+  leave (q, &statusMain[prodId]);
+}
+
+/**
+ *  \brief Retrieve an item from a queue, waiting while it is empty.
+ *
+ *  \param q queue
+ *  \param consId consumer identification
+ *  \param item returns the item
+ *
+ *  \return false if the queue is empty and every producer closed it
+ */
+
+bool queueGet (Queue *q, unsigned int consId, void *item)
+{
+  bool waited = false;                                                    /* whether the queue was empty */
+  double t = 0.0;                                                                          /* start of the wait */
+
+  enter (q, &statusWorkers[consId]);
+  if ((q->count == 0) && (q->nProducers > 0))
+     { q->emptyWaits += 1;
+       q->totalEmptyWaits += 1;
+       waited = true;
+       t = traceNow ();
+     }
+  while ((q->count == 0) && (q->nProducers > 0))                                 /* wait if the queue is empty */
+  { if ((statusWorkers[consId] = pthread_cond_wait (&q->notEmpty, &q->accessCR)) != 0)
+       { errno = statusWorkers[consId];                                                       /* save error in errno */
+         perror ("error on waiting in notEmpty");
+         statusWorkers[consId] = EXIT_FAILURE;
+         pthread_exit (&statusWorkers[consId]);
+       }
+  }
+  if (waited) traceEvent (consId, "waitGet", t, -1, -1, 0);
+  if (q->count == 0)                                                         /* empty, and no more items to come */
+     { leave (q, &statusWorkers[consId]);
+       return false;
+     }
+  memcpy (item, q->mem + q->ri * q->itemSize, q->itemSize);
+  q->ri = (q->ri + 1) % q->capacity;
+  q->count -= 1;
+  adapt (q);
+  wakeUp (&q->notFull, false, &statusWorkers[consId]);                       /* let a producer know of the room */
+  leave (q, &statusWorkers[consId]);
+
+  return true;
+}
+
+/**
+ *  \brief Signal a producer will store no more items in a queue.
+ *
+ *  \param q queue
+ *  \param prodId producer identification
+ */
+
+void queueClose (Queue *q, unsigned int prodId)
+{
+  enter (q, &statusMain[prodId]);
+  q->nProducers -= 1;
+  if (q->nProducers == 0) wakeUp (&q->notEmpty, true, &statusMain[prodId]);   /* let every consumer finish */
+  leave (q, &statusMain[prodId]);
+}
+
+/**
+ *  \brief Release the storage of a queue.
+ *
+ *  \param q queue
+ */
+
+void queueDestroy (Queue *q)
+{
+  free (q->mem);
+  q->mem = NULL;
+  pthread_cond_destroy (&q->notFull);
+  pthread_cond_destroy (&q->notEmpty);
+  pthread_mutex_destroy (&q->accessCR);
+}
@@ -0,0 +1,105 @@
+/**
+ *  \file queue.h (interface file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Synchronization based on monitors.
+ *  Both threads and the monitor are implemented using the pthread library which enables the creation of a
+ *  monitor of the Lampson / Redell type.
+ *
+ *  Bounded queues between the stages of a pipeline, each one implemented as a monitor of its own.
+ *
+ *  A queue starts small and grows, up to a maximum capacity, while the stages it connects keep alternating between a
+ *  producer waiting for room and a consumer waiting for items: the difference of throughput of the two stages is
+ *  then absorbed by a deeper queue. A queue whose stages never wait on each other keeps its initial size.
+ *
+ *  Definition of the operations carried out by the producers / consumers:
+ *     \li queueInit
+ *     \li queuePut
+ *     \li queueGet
+ *     \li queueClose
+ *     \li queueDestroy.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+
+/**
+ * \brief Struct to store a bounded queue of fixed size items
+ */
+typedef struct
+{
+    const char *name;                                                                /* name, for the statistics */
+    size_t itemSize;                                                                       /* bytes of an item */
+    unsigned char *mem;                                                                      /* storage region */
+    int capacity;                                                            /* number of items that can be stored */
+    int maxCapacity;                                                                 /* largest capacity allowed */
+    int initCapacity;                                                                        /* initial capacity */
+    int ri;                                                                                  /* retrieval pointer */
+    int count;                                                                        /* number of items stored */
+    int nProducers;                                                       /* number of producers still storing */
+    int fullWaits;                                                  /* producer waits in the current window */
+    int emptyWaits;                                                 /* consumer waits in the current window */
+    int windowOps;                                                      /* operations in the current window */
+    long long totalFullWaits;                                                           /* producer waits */
+    long long totalEmptyWaits;                                                          /* consumer waits */
+    long long nItems;                                                             /* number of items stored */
+    pthread_mutex_t accessCR;                     /* locking flag which warrants mutual exclusion inside the monitor */
+    pthread_cond_t notFull;                              /* producers synchronization point when the queue is full */
+    pthread_cond_t notEmpty;                            /* consumers synchronization point when the queue is empty */
+} Queue;
+
+/**
+ *  \brief Initialize an empty queue.
+ *
+ *  \param q queue
+ *  \param name name of the queue
+ *  \param itemSize number of bytes of an item
+ *  \param capacity initial number of items that can be stored
+ *  \param maxCapacity largest number of items that can be stored
+ *  \param nProducers number of producers, each of which closes the queue when done
+ */
+extern void queueInit (Queue *q, const char *name, size_t itemSize, int capacity, int maxCapacity, int nProducers);
+
+/**
+ *  \brief Store an item in a queue, waiting while it is full.
+ *
+ *  \param q queue
+ *  \param prodId producer identification
+ *  \param item item to be copied into the queue
+ */
+extern void queuePut (Queue *q, unsigned int prodId, const void *item);
+
+/**
+ *  \brief Retrieve an item from a queue, waiting while it is empty.
+ *
+ *  \param q queue
+ *  \param consId consumer identification
+ *  \param item returns the item
+ *
+ *  \return false if the queue is empty and every producer closed it
+ */
+extern bool queueGet (Queue *q, unsigned int consId, void *item);
+
+/**
+ *  \brief Signal a producer will store no more items in a queue.
+ *
+ *  \param q queue
+ *  \param prodId producer identification
+ */
+extern void queueClose (Queue *q, unsigned int prodId);
+
+/**
+ *  \brief Release the storage of a queue.
+ *
+ *  \param q queue
+ */
+extern void queueDestroy (Queue *q);
+
+#endif /* QUEUE_H */
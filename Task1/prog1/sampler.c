@@ -0,0 +1,359 @@
+/**
+ *  \file sampler.c (implementation file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Approximate counting of large files from a stratified random sample of their chunks.
+ *
+ *  The total of each stratum is estimated as its number of bytes times the density of the chunks sampled from it
+ *  (a ratio estimator), and its variance from the spread of the chunks around that density. The fraction of the
+ *  words with a letter is a ratio of two totals, whose variance is that of the total of the linearized variable
+ *  letters - ratio * words, over the square of the number of words.
+ *
+ *  Definition of the operations:
+ *     \li sampleInit
+ *     \li sampleFile
+ *     \li sampleBounds
+ *     \li sampleReport.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <sys/types.h>
+
+#include "probConst.h"
+#include "dataStructures.h"
+#include "countWords.h"
+#include "chunkReader.h"
+#include "planner.h"
+#include "trace.h"
+#include "sampler.h"
+
+/** \brief quantile of the normal distribution for 95% confidence intervals */
+#define Z95          1.96
+
+/** \brief number of variables estimated: words, A, E, I, O, U, Y, C and invalid sequences */
+#define NVARS        9
+
+/** \brief half width of the confidence intervals requested (0 to count every chunk) */
+double samplePrecision = 0.0;
+
+/**
+ * \brief Struct to store a chunk of the sample
+ */
+typedef struct
+{
+    int stratum;
+    int bytes;
+    int y[NVARS];
+} Sample;
+
+/**
+ * \brief Struct to store the sample of a file and its estimates
+ */
+typedef struct
+{
+    bool sampled;                                                          /* false if the file was counted whole */
+    off_t fileBytes;
+    off_t sampledBytes;
+    int nSamples;
+    int capacity;
+    Sample *samples;
+    double est[NVARS];                                                                   /* estimated totals */
+    double half[NVARS];           /* half widths: of the number of words, then of the fractions of the words */
+    double countHalf[NVARS];                                             /* half widths of the estimated totals */
+} FileSample;
+
+/** \brief sample of each file */
+static FileSample *files;
+
+/**
+ *  \brief Get ready to sample the chunks of a list of files.
+ *
+ *  \param nFiles number of files
+ */
+
+void sampleInit (int nFiles)
+{
+  if ((files = calloc (nFiles + 1, sizeof (FileSample))) == NULL)
+     { fprintf (stderr, "error on allocating space to the samples\n");
+       exit (EXIT_FAILURE);
+     }
+}
+
+/**
+ *  \brief Get a random offset.
+ *
+ *  Internal operation.
+ *
+ *  \param n number of offsets to choose from
+ *
+ *  \return offset in [0, n)
+ */
+
+static off_t randomOffset (off_t n)
+{
+  unsigned long long r = ((unsigned long long) random () << 31) | (unsigned long long) random ();
+
+  return (off_t) (r % (unsigned long long) n);
+}
+
+/**
+ *  \brief Get the first byte of a stratum of a file.
+ *
+ *  Internal operation.
+ *
+ *  \param fs sample of the file
+ *  \param h stratum
+ *
+ *  \return offset of the stratum
+ */
+
+static off_t stratumStart (FileSample *fs, int h)
+{
+  return (off_t) ((long double) fs->fileBytes * h / STRATA);
+}
+
+/**
+ *  \brief Get the variance of the estimated total of the variable y[k] - r * y[0] of a file.
+ *
+ *  The chunks are sampled with replacement (they may overlap), so no finite population correction applies.
+ *
+ *  Internal operation.
+ *
+ *  \param fs sample of the file
+ *  \param k index of the variable
+ *  \param r multiple of the number of words subtracted (0 for the total of the variable itself)
+ *
+ *  \return variance
+ */
+
+static double totalVariance (FileSample *fs, int k, double r)
+{
+  double sumB[STRATA] = { 0.0 }, sumU[STRATA] = { 0.0 }, ss[STRATA] = { 0.0 };
+  int n[STRATA] = { 0 };
+  double v = 0.0;
+
+  for (int s = 0; s < fs->nSamples; s++)
+  { Sample *x = &fs->samples[s];
+    n[x->stratum] += 1;
+    sumB[x->stratum] += x->bytes;
+    sumU[x->stratum] += x->y[k] - r * x->y[0];
+  }
+  for (int s = 0; s < fs->nSamples; s++)                          /* spread around the density of the stratum */
+  { Sample *x = &fs->samples[s];
+    double d = (sumB[x->stratum] > 0.0) ? sumU[x->stratum] / sumB[x->stratum] : 0.0;
+    double e = x->y[k] - r * x->y[0] - d * x->bytes;
+    ss[x->stratum] += e * e;
+  }
+  for (int h = 0; h < STRATA; h++)
+  { double bytes = (double) (stratumStart (fs, h + 1) - stratumStart (fs, h));
+    if ((n[h] < 2) || (sumB[h] <= 0.0)) continue;
+    double mean = sumB[h] / n[h];                                            /* mean bytes of a sampled chunk */
+    v += bytes * bytes * ss[h] / ((n[h] - 1) * n[h] * mean * mean);
+  }
+
+  return v;
+}
+
+/**
+ *  \brief Estimate the totals of a file and the half widths of their confidence intervals.
+ *
+ *  Internal operation.
+ *
+ *  \param fs sample of the file
+ *
+ *  \return true if the intervals are as narrow as requested
+ */
+
+static bool estimate (FileSample *fs)
+{
+  double sumB[STRATA] = { 0.0 }, sumY[STRATA][NVARS];
+  bool precise;
+
+  memset (sumY, 0, sizeof (sumY));
+  for (int s = 0; s < fs->nSamples; s++)
+  { Sample *x = &fs->samples[s];
+    sumB[x->stratum] += x->bytes;
+    for (int k = 0; k < NVARS; k++)
+      sumY[x->stratum][k] += x->y[k];
+  }
+  for (int k = 0; k < NVARS; k++)
+  { fs->est[k] = 0.0;
+    for (int h = 0; h < STRATA; h++)
+      if (sumB[h] > 0.0)
+         fs->est[k] += (double) (stratumStart (fs, h + 1) - stratumStart (fs, h)) * sumY[h][k] / sumB[h];
+  }
+
+  fs->half[0] = Z95 * sqrt (totalVariance (fs, 0, 0.0));
+  precise = (fs->half[0] <= samplePrecision * fs->est[0]);
+  for (int k = 1; k < NVARS - 1; k++)                                     /* fractions of the words with a letter */
+  { double r = (fs->est[0] > 0.0) ? fs->est[k] / fs->est[0] : 0.0;
+    fs->half[k] = (fs->est[0] > 0.0) ? Z95 * sqrt (totalVariance (fs, k, r)) / fs->est[0] : 0.0;
+    precise = precise && (fs->half[k] <= samplePrecision);
+  }
+
+  return precise;
+}
+
+/**
+ *  \brief Round estimated totals to the results of a file.
+ *
+ *  Internal operation.
+ *
+ *  \param x totals of the variables (words, A, E, I, O, U, Y, C and invalid sequences)
+ *  \param res results, whose counters are set
+ */
+
+static void toResults (const double *x, TempResults *res)
+{
+  res->nWords = llround (x[0]);
+  res->a = llround (x[1]);
+  res->e = llround (x[2]);
+  res->i = llround (x[3]);
+  res->o = llround (x[4]);
+  res->u = llround (x[5]);
+  res->y = llround (x[6]);
+  res->c = llround (x[7]);
+  res->nInvalid = llround (x[8]);
+}
+
+/**
+ *  \brief Estimate the results of a file from a sample of its chunks.
+ *
+ *  A file whose sample grows past half of it is counted whole, and the sample is discarded: in the worst case
+ *  about one and a half times the file is read.
+ *
+ *  \param fileID file identification
+ *  \param fileName name of the file
+ *  \param chunk chunk to read the sample to
+ *  \param res returns the estimated results of the file
+ *  \param slot trace slot of the calling thread
+ *
+ *  \return SAMPLE_DONE if the results were estimated, SAMPLE_WHOLE if the file must be counted whole instead (or
+ *          could not be read)
+ */
+
+int sampleFile (int fileID, const char *fileName, Chunk *chunk, TempResults *res, int slot)
+{
+  FileSample *fs = &files[fileID];
+  TempResults r;
+  FILE *fp;
+  bool precise = false;
+
+  fs->fileBytes = fileSize (fileName);
+  if ((fs->fileBytes < SAMPLEMIN) || ((fp = fopen (fileName, "rb")) == NULL)) return SAMPLE_WHOLE;
+  r.patternCounts = NULL;
+  chunk->fileID = fileID;
+  for (int round = 1; !precise; round++)
+  { if (2 * fs->sampledBytes >= fs->fileBytes)                              /* sampling would not pay off */
+       { fclose (fp);
+         free (fs->samples);
+         memset (fs, 0, sizeof (FileSample));
+         return SAMPLE_WHOLE;
+       }
+    if (fs->nSamples + STRATA > fs->capacity)                                  /* room for a chunk of each stratum */
+       { fs->capacity = 2 * fs->capacity + STRATA;
+         if ((fs->samples = realloc (fs->samples, fs->capacity * sizeof (Sample))) == NULL)
+            { fprintf (stderr, "error on allocating space to the sample\n");
+              exit (EXIT_FAILURE);
+            }
+       }
+    for (int h = 0; h < STRATA; h++)                                                /* a chunk of each stratum */
+    { off_t start = stratumStart (fs, h);
+      double t = traceNow ();
+      chunk->numBytes = chunk->overlap = 0;
+      chunk->index = fs->nSamples;
+      if (!seekChunk (fp, start + randomOffset (stratumStart (fs, h + 1) - start))) readChunk (fp, chunk);
+      traceEvent (slot, "sample", t, fileID, chunk->index, chunk->numBytes);
+      count (chunk, &r);
+      Sample *x = &fs->samples[fs->nSamples++];
+      x->stratum = h;
+      x->bytes = chunk->numBytes;
+      x->y[0] = r.nWords;
+      x->y[1] = r.a;
+      x->y[2] = r.e;
+      x->y[3] = r.i;
+      x->y[4] = r.o;
+      x->y[5] = r.u;
+      x->y[6] = r.y;
+      x->y[7] = r.c;
+      x->y[8] = r.nInvalid;
+      fs->sampledBytes += chunk->numBytes;
+    }
+    precise = (round >= MINROUNDS) && estimate (fs);
+  }
+  fclose (fp);
+  fs->sampled = true;
+  for (int k = 0; k < NVARS; k++)
+    fs->countHalf[k] = Z95 * sqrt (totalVariance (fs, k, 0.0));
+
+  int *counts = res->patternCounts;                                      /* scale the sample up to the whole file */
+  memset (res, 0, sizeof (TempResults));
+  res->fileID = fileID;
+  res->patternCounts = counts;
+  toResults (fs->est, res);
+
+  return SAMPLE_DONE;
+}
+
+/**
+ *  \brief Get the 95% confidence intervals of the counts of a file.
+ *
+ *  \param fileID file identification
+ *  \param low returns the lower bounds of the counts
+ *  \param high returns the upper bounds of the counts
+ *
+ *  \return true if the results of the file were estimated, false if it was counted whole (the bounds are then
+ *          left untouched)
+ */
+
+bool sampleBounds (int fileID, TempResults *low, TempResults *high)
+{
+  double lo[NVARS], hi[NVARS];
+
+  if ((files == NULL) || !files[fileID].sampled) return false;
+  for (int k = 0; k < NVARS; k++)
+  { lo[k] = files[fileID].est[k] - files[fileID].countHalf[k];
+    if (lo[k] < 0.0) lo[k] = 0.0;
+    hi[k] = files[fileID].est[k] + files[fileID].countHalf[k];
+  }
+  toResults (lo, low);
+  toResults (hi, high);
+
+  return true;
+}
+
+/**
+ *  \brief Print the size of the sample and the confidence intervals of each file.
+ *
+ *  \param fp stream to print to
+ *  \param nFiles number of files
+ *  \param fileNames names of the files
+ */
+
+void sampleReport (FILE *fp, int nFiles, char *fileNames[])
+{
+  static const char *letters[] = { "A", "E", "I", "O", "U", "Y", "C" };
+
+  fprintf (fp, "Sampled chunks, with 95%% confidence intervals (words, then fraction of the words with each "
+           "letter):\n");
+  for (int f = 0; f < nFiles; f++)
+  { FileSample *fs = &files[f];
+    if (!fs->sampled)
+       { fprintf (fp, "%s: not sampled\n", fileNames[f]);
+         continue;
+       }
+    fprintf (fp, "%s: %d chunks (%.2f%% of the bytes), words %.0f +- %.0f", fileNames[f], fs->nSamples,
+             100.0 * fs->sampledBytes / fs->fileBytes, fs->est[0], fs->half[0]);
+    for (int k = 1; k < NVARS - 1; k++)
+      fprintf (fp, ", %s %.4f +- %.4f", letters[k - 1], (fs->est[0] > 0.0) ? fs->est[k] / fs->est[0] : 0.0,
+               fs->half[k]);
+    fprintf (fp, "\n");
+  }
+}
@@ -0,0 +1,80 @@
+/**
+ *  \file sampler.h (interface file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Approximate counting of large files from a stratified random sample of their chunks.
+ *
+ *  A file is divided in STRATA strata of the same number of bytes, and every round one chunk is sampled from each
+ *  stratum: the chunk which starts at the first word boundary after a random offset. The chunks sampled are thus not
+ *  the ones the file would be split in, and may overlap. Once every stratum has MINROUNDS chunks, the results of the
+ *  file are estimated from the density (per byte) of each stratum, with 95% confidence intervals for the number of
+ *  words and for the fraction of the words with each letter. Sampling stops as soon as the intervals are as narrow
+ *  as requested; a file whose sample would grow past half of it, or smaller than SAMPLEMIN bytes, is counted whole.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stdio.h>
+
+#include "dataStructures.h"
+
+/** \brief the file must be counted whole */
+#define SAMPLE_WHOLE   0
+
+/** \brief the results of the file were estimated from a sample */
+#define SAMPLE_DONE    1
+
+/** \brief half width of the confidence intervals requested: relative for the number of words, absolute for the
+ *  fractions of the words with each letter (0 to count every chunk) */
+extern double samplePrecision;
+
+/**
+ *  \brief Get ready to sample the chunks of a list of files.
+ *
+ *  \param nFiles number of files
+ */
+extern void sampleInit (int nFiles);
+
+/**
+ *  \brief Estimate the results of a file from a sample of its chunks.
+ *
+ *  A file whose sample grows past half of it is counted whole, and the sample is discarded: in the worst case
+ *  about one and a half times the file is read.
+ *
+ *  \param fileID file identification
+ *  \param fileName name of the file
+ *  \param chunk chunk to read the sample to
+ *  \param res returns the estimated results of the file
+ *  \param slot trace slot of the calling thread
+ *
+ *  \return SAMPLE_DONE if the results were estimated, SAMPLE_WHOLE if the file must be counted whole instead (or
+ *          could not be read)
+ */
+extern int sampleFile (int fileID, const char *fileName, Chunk *chunk, TempResults *res, int slot);
+
+/**
+ *  \brief Get the 95% confidence intervals of the counts of a file.
+ *
+ *  \param fileID file identification
+ *  \param low returns the lower bounds of the counts
+ *  \param high returns the upper bounds of the counts
+ *
+ *  \return true if the results of the file were estimated, false if it was counted whole (the bounds are then
+ *          left untouched)
+ */
+extern bool sampleBounds (int fileID, TempResults *low, TempResults *high);
+
+/**
+ *  \brief Print the size of the sample and the confidence intervals of each file.
+ *
+ *  \param fp stream to print to
+ *  \param nFiles number of files
+ *  \param fileNames names of the files
+ */
+extern void sampleReport (FILE *fp, int nFiles, char *fileNames[]);
+
+#endif /* SAMPLER_H */
@@ -0,0 +1,275 @@
+/**
+ *  \file shard.c (implementation file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Result shards: compact binary files with the results of a set of files, which can be merged exactly.
+ *
+ *  Definition of the operations:
+ *     \li writeShard
+ *     \li readShard
+ *     \li mergeShards.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "dataStructures.h"
+#include "sharedRegion.h"
+#include "shard.h"
+#include "binFile.h"
+#include "utils.h"
+
+/** \brief shard identification */
+static const char magic[4] = { 'C', 'L', 'E', '3' };
+
+/** \brief number of counters stored for each file */
+#define NCOUNTERS    9
+
+/**
+ *  \brief Read a 32 bit integer, aborting on a truncated shard.
+ *
+ *  Internal operation.
+ *
+ *  \param fp stream to read from
+ *  \param path name of the shard (for error reporting)
+ *
+ *  \return value read
+ */
+
+static int32_t getInt (FILE *fp, const char *path)
+{
+  int32_t val;
+
+  if (!getInt32 (fp, &val))
+     { fprintf (stderr, "%s: truncated shard\n", path);
+       exit (EXIT_FAILURE);
+     }
+  return val;
+}
+
+/**
+ *  \brief Read a 64 bit integer, aborting on a truncated shard.
+ *
+ *  Internal operation.
+ *
+ *  \param fp stream to read from
+ *  \param path name of the shard (for error reporting)
+ *
+ *  \return value read
+ */
+
+static long long getLong (FILE *fp, const char *path)
+{
+  long long val;
+
+  if (!getInt64 (fp, &val))
+     { fprintf (stderr, "%s: truncated shard\n", path);
+       exit (EXIT_FAILURE);
+     }
+  return val;
+}
+
+/**
+ * \brief Struct to store the results of a set of files, while they are written to a shard
+ */
+typedef struct
+{
+    int nFiles;
+    char **fileNames;
+    TempResults *res;
+    bool *processed;
+} ShardContents;
+
+/**
+ *  \brief Write the results of a set of files, as the contents of a shard.
+ *
+ *  Internal operation.
+ *
+ *  \param fp stream to write to
+ *  \param arg results of the files, as a ShardContents
+ *
+ *  \return true on success
+ */
+
+static bool putShard (FILE *fp, void *arg)
+{
+  ShardContents *sc = arg;
+  bool ok;
+
+  ok = (fwrite (magic, sizeof (magic), 1, fp) == 1) && putInt32 (fp, sc->nFiles);
+  for (int f = 0; ok && (f < sc->nFiles); f++)
+  { int32_t len = (int32_t) strlen (sc->fileNames[f]);
+    TempResults *r = &sc->res[f];
+    ok = putInt32 (fp, len) && ((len == 0) || (fwrite (sc->fileNames[f], len, 1, fp) == 1)) &&
+         putInt32 (fp, sc->processed[f] ? 1 : 0) && putInt64 (fp, r->nWords) && putInt64 (fp, r->a) &&
+         putInt64 (fp, r->e) && putInt64 (fp, r->i) && putInt64 (fp, r->o) && putInt64 (fp, r->u) &&
+         putInt64 (fp, r->c) && putInt64 (fp, r->y) && putInt64 (fp, r->nInvalid);
+  }
+
+  return ok;
+}
+
+/**
+ *  \brief Write the results of a set of files to a shard.
+ *
+ *  The shard is replaced whole, so it is either complete or absent.
+ *
+ *  \param path name of the shard
+ *  \param nFiles number of files
+ *  \param fileNames names of the files
+ *  \param res results of the files
+ *  \param processed flags signaling each file was processed
+ */
+
+void writeShard (const char *path, int nFiles, char *fileNames[], TempResults *res, bool *processed)
+{
+  ShardContents sc = { nFiles, fileNames, res, processed };
+
+  if (!replaceFile (path, putShard, &sc))
+     { perror (path);
+       exit (EXIT_FAILURE);
+     }
+}
+
+/**
+ *  \brief Read the results stored in a shard.
+ *
+ *  \param path name of the shard
+ *  \param fileNames returns the names of the files (allocated)
+ *  \param res returns the results of the files (allocated)
+ *  \param processed returns the flags signaling each file was processed (allocated)
+ *
+ *  \return number of files
+ */
+
+int readShard (const char *path, char ***fileNames, TempResults **res, bool **processed)
+{
+  FILE *fp;
+  char id[4];
+  int nFiles;
+
+  if ((fp = fopen (path, "rb")) == NULL)
+     { perror (path);
+       exit (EXIT_FAILURE);
+     }
+  if ((fread (id, sizeof (id), 1, fp) != 1) ||
+      (memcmp (id, magic, sizeof (magic)) != 0) ||
+      ((nFiles = getInt (fp, path)) < 0))
+     { fprintf (stderr, "%s: not a result shard\n", path);
+       exit (EXIT_FAILURE);
+     }
+
+  if (((*fileNames = malloc ((nFiles + 1) * sizeof (char *))) == NULL) ||
+      ((*res = calloc (nFiles + 1, sizeof (TempResults))) == NULL) ||
+      ((*processed = malloc ((nFiles + 1) * sizeof (bool))) == NULL))
+     { fprintf (stderr, "error on allocating space to the shard results\n");
+       exit (EXIT_FAILURE);
+     }
+  for (int f = 0; f < nFiles; f++)
+  { int32_t len = getInt (fp, path);
+    if ((len < 0) || (((*fileNames)[f] = malloc (len + 1)) == NULL) ||
+        ((len > 0) && (fread ((*fileNames)[f], len, 1, fp) != 1)))
+       { fprintf (stderr, "%s: malformed shard\n", path);
+         exit (EXIT_FAILURE);
+       }
+    (*fileNames)[f][len] = '\0';
+    (*res)[f].fileID = f;
+    (*processed)[f] = (getInt (fp, path) != 0);
+    (*res)[f].nWords = getLong (fp, path);
+    (*res)[f].a = getLong (fp, path);
+    (*res)[f].e = getLong (fp, path);
+    (*res)[f].i = getLong (fp, path);
+    (*res)[f].o = getLong (fp, path);
+    (*res)[f].u = getLong (fp, path);
+    (*res)[f].c = getLong (fp, path);
+    (*res)[f].y = getLong (fp, path);
+    (*res)[f].nInvalid = getLong (fp, path);
+  }
+  fclose (fp);
+
+  return nFiles;
+}
+
+/**
+ *  \brief Merge a set of shards into the shared region.
+ *
+ *  Every shard holds whole files, so a file present in several shards (the same shard given twice, or overlapping
+ *  shards) is an error. A file which was not processed is signaled as not processed.
+ *
+ *  \param nShards number of shards
+ *  \param paths names of the shards
+ *  \param fileNames returns the names of the merged files (allocated)
+ *
+ *  \return number of merged files
+ */
+
+int mergeShards (int nShards, char *paths[], char ***fileNames)
+{
+  char ***names;                                                                   /* file names of each shard */
+  TempResults **res;                                                                  /* results of each shard */
+  bool **processed;                                                   /* files processed, for each shard */
+  int *nEntries;                                                                  /* number of files of each shard */
+  int nTotal = 0;                                                          /* number of entries of all shards */
+
+  if (((names = malloc (nShards * sizeof (char **))) == NULL) ||
+      ((res = malloc (nShards * sizeof (TempResults *))) == NULL) ||
+      ((processed = malloc (nShards * sizeof (bool *))) == NULL) ||
+      ((nEntries = malloc (nShards * sizeof (int))) == NULL))
+     { fprintf (stderr, "error on allocating space to the shards\n");
+       exit (EXIT_FAILURE);
+     }
+  for (int s = 0; s < nShards; s++)
+  { nEntries[s] = readShard (paths[s], &names[s], &res[s], &processed[s]);
+    nTotal += nEntries[s];
+  }
+
+  int *shardOf;                                                                /* shard holding each file */
+  if (((*fileNames = malloc ((nTotal + 1) * sizeof (char *))) == NULL) ||
+      ((shardOf = malloc ((nTotal + 1) * sizeof (int))) == NULL))
+     { fprintf (stderr, "error on allocating space to the shards\n");
+       exit (EXIT_FAILURE);
+     }
+  int m = 0;
+  for (int s = 0; s < nShards; s++)                 /* a file is whole in its shard: it can not be in another one */
+    for (int f = 0; f < nEntries[s]; f++, m++)
+    { for (int k = 0; k < m; k++)
+        if ((shardOf[k] != s) && (strcmp ((*fileNames)[k], names[s][f]) == 0))
+           { fprintf (stderr, "%s: %s is also in %s, shards must not overlap\n", paths[s], names[s][f],
+                      paths[shardOf[k]]);
+             exit (EXIT_FAILURE);
+           }
+      (*fileNames)[m] = names[s][f];
+      shardOf[m] = s;
+      res[s][f].fileID = m;
+    }
+
+  storeFileNames (0, nTotal, *fileNames);
+  for (int s = 0; s < nShards; s++)
+    for (int f = 0; f < nEntries[s]; f++)
+      if (processed[s][f])
+         { savePartialResults (0, &res[s][f]);
+           storeFileChunks (0, res[s][f].fileID, 1);
+         }
+      else { fprintf (stderr, "%s: %s was not processed\n", paths[s], names[s][f]);
+             storeFileFailure (0, res[s][f].fileID);
+           }
+
+  for (int s = 0; s < nShards; s++)
+  { free (names[s]);
+    free (res[s]);
+    free (processed[s]);
+  }
+  free (res);
+  free (processed);
+  free (names);
+  free (nEntries);
+  free (shardOf);
+
+  return nTotal;
+}
@@ -0,0 +1,62 @@
+/**
+ *  \file shard.h (interface file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Result shards: compact binary files with the results of a set of files, which can be merged exactly.
+ *
+ *  Shard layout (integers little-endian):
+ *     \li magic "CLE3" and the number of files, as a 32 bit integer
+ *     \li for each file, the length of its name, the name, a flag signaling the file was processed and the nine
+ *         64 bit counters (words, A, E, I, O, U, C, Y and invalid sequences).
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <stdbool.h>
+
+#include "dataStructures.h"
+
+/**
+ *  \brief Write the results of a set of files to a shard.
+ *
+ *  The shard is replaced whole, so it is either complete or absent.
+ *
+ *  \param path name of the shard
+ *  \param nFiles number of files
+ *  \param fileNames names of the files
+ *  \param res results of the files
+ *  \param processed flags signaling each file was processed
+ */
+extern void writeShard (const char *path, int nFiles, char *fileNames[], TempResults *res, bool *processed);
+
+/**
+ *  \brief Read the results stored in a shard.
+ *
+ *  \param path name of the shard
+ *  \param fileNames returns the names of the files (allocated)
+ *  \param res returns the results of the files (allocated)
+ *  \param processed returns the flags signaling each file was processed (allocated)
+ *
+ *  \return number of files
+ */
+extern int readShard (const char *path, char ***fileNames, TempResults **res, bool **processed);
+
+/**
+ *  \brief Merge a set of shards into the shared region.
+ *
+ *  Every shard holds whole files, so a file present in several shards (the same shard given twice, or overlapping
+ *  shards) is an error. A file which was not processed is signaled as not processed.
+ *
+ *  \param nShards number of shards
+ *  \param paths names of the shards
+ *  \param fileNames returns the names of the merged files (allocated)
+ *
+ *  \return number of merged files
+ */
+extern int mergeShards (int nShards, char *paths[], char ***fileNames);
+
+#endif /* SHARD_H */
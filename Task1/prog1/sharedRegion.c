@@ -17,6 +17,9 @@
 
 #include "probConst.h"
 #include "dataStructures.h"
+#include "sharedRegion.h"
+#include "patterns.h"
+#include "sampler.h"
 
 /** \brief Number of files to be processed */
 int nFiles;
@@ -30,12 +33,51 @@ extern int* statusWorkers;
 /** \brief producer thread return status array */
 extern int* statusMain;
 
+/** \brief output format of the results */
+extern int outFormat;
+
 /** \brief chunks storage region */
 static TempResults* mem;
 
+/** \brief occurrences of each pattern in each file */
+static int* patternTotals;
+
+/** \brief number of chunks of each file, or -1 while the file is still being read */
+static int* chunksExpected;
+
+/** \brief number of chunks of each file already counted */
+static int* chunksDone;
+
+/** \brief flag signaling the results of each file were already printed */
+static bool* printed;
+
+/** \brief flag signaling each file could not be processed */
+static bool* failed;
+
+/** \brief next file to be counted whole by a worker */
+static int nextFile;
+
+/** \brief order in which the files are counted whole by the workers, or NULL for the order they were stored in */
+static int* fileOrder;
+
+/** \brief earliest file with the same contents as each file, or -1 (NULL if copies are not looked for) */
+static int* copyOf;
+
+/** \brief next file with the same contents as each file, or -1 */
+static int* nextCopy;
+
+/** \brief number of chunks counted, of all files */
+static int totalDone;
+
+/** \brief number of chunks the producer is waiting to be counted, or -1 if it is not waiting */
+static int totalWanted = -1;
+
 /** \brief locking flag which warrants mutual exclusion inside the monitor */
 static pthread_mutex_t accessCR = PTHREAD_MUTEX_INITIALIZER;
 
+/** \brief producer synchronization point when it waits for the chunks to be counted */
+static pthread_cond_t allCounted = PTHREAD_COND_INITIALIZER;
+
 /** \brief flag which warrants that the data transfer region is initialized exactly once */
 static pthread_once_t init = PTHREAD_ONCE_INIT;
 
@@ -50,8 +92,195 @@ static pthread_once_t init = PTHREAD_ONCE_INIT;
  */
 void initialization (void)
 {
-    /* initialize FIFO in empty state */
-    mem = (TempResults*) malloc(sizeof(TempResults)*nFiles);
+    /* initialize the results of every file to zero */
+    mem = (TempResults*) calloc(nFiles, sizeof(TempResults));
+    chunksExpected = (int*) malloc(sizeof(int)*nFiles);
+    chunksDone = (int*) calloc(nFiles, sizeof(int));
+    printed = (bool*) calloc(nFiles, sizeof(bool));
+    failed = (bool*) calloc(nFiles, sizeof(bool));
+    if ((mem == NULL) || (chunksExpected == NULL) || (chunksDone == NULL) || (printed == NULL) || (failed == NULL))
+    { fprintf (stderr, "error on allocating space to the results region\n");
+      exit (EXIT_FAILURE);
+    }
+    for (int i = 0; i < nFiles; ++i)
+        chunksExpected[i] = -1;
+    if (nPatterns > 0)                                               /* the occurrences of the patterns, if any */
+    {
+        if ((patternTotals = (int*) calloc((size_t) nFiles * nPatterns, sizeof(int))) == NULL)
+        { fprintf (stderr, "error on allocating space to the results region\n");
+          exit (EXIT_FAILURE);
+        }
+        for (int i = 0; i < nFiles; ++i)
+            mem[i].patternCounts = patternTotals + (size_t) i * nPatterns;
+    }
+}
+
+/**
+ *  \brief Print a string quoted according to the output format.
+ *
+ *  Internal monitor operation.
+ *
+ *  \param str string to be printed
+ */
+static void printQuoted(const char *str)
+{
+    putchar('"');
+    for (; *str != '\0'; str++)
+    {
+        if (outFormat == OUT_CSV && *str == '"') printf("\"\"");
+        else if (outFormat == OUT_JSON && (*str == '"' || *str == '\\')) printf("\\%c", *str);
+        else if (outFormat == OUT_JSON && (unsigned char) *str < 0x20) printf("\\u%04x", *str);
+        else putchar(*str);
+    }
+    putchar('"');
+}
+
+/**
+ *  \brief Print the occurrences of the patterns in a file according to the output format.
+ *
+ *  Internal monitor operation.
+ *
+ *  \param i file identification
+ */
+static void printPatternCounts(int i)
+{
+    int *counts = mem[i].patternCounts;
+    bool first = true;
+
+    switch (outFormat)
+    {
+        case OUT_JSON:
+            printf(", \"patterns\": {");
+            for (int p = 0; p < nPatterns; p++)
+            {
+                printf("%s", (p > 0) ? ", " : "");
+                printQuoted(patternNames[p]);
+                printf(": %d", counts[p]);
+            }
+            printf("}");
+            break;
+        case OUT_CSV:                                                         /* a column for each pattern */
+            for (int p = 0; p < nPatterns; p++)
+                printf(",%d", counts[p]);
+            break;
+        default:
+            for (int p = 0; p < nPatterns; p++)
+                if (counts[p] > 0)
+                {
+                    if (first) printf("Pattern occurrences\n");
+                    printf("\t%s\t%d\n", patternNames[p], counts[p]);
+                    first = false;
+                }
+    }
+}
+
+/**
+ *  \brief Print whether the results of a file were estimated from a sample, and the bounds of its counts.
+ *
+ *  The bounds are the 95% confidence intervals of an estimated file, and the counts themselves otherwise.
+ *
+ *  Internal monitor operation.
+ *
+ *  \param i file identification
+ */
+static void printBounds(int i)
+{
+    TempResults low = mem[i], high = mem[i];
+    bool estimated = sampleBounds(i, &low, &high);
+
+    if (outFormat == OUT_JSON)
+    {
+        printf(", \"estimated\": %s", estimated ? "true" : "false");
+        printf(", \"low\": {\"words\": %lld, \"a\": %lld, \"e\": %lld, \"i\": %lld, \"o\": %lld, \"u\": %lld, "
+               "\"y\": %lld, \"c\": %lld, \"invalid\": %lld}", low.nWords, low.a, low.e, low.i, low.o, low.u, low.y,
+               low.c, low.nInvalid);
+        printf(", \"high\": {\"words\": %lld, \"a\": %lld, \"e\": %lld, \"i\": %lld, \"o\": %lld, \"u\": %lld, "
+               "\"y\": %lld, \"c\": %lld, \"invalid\": %lld}", high.nWords, high.a, high.e, high.i, high.o, high.u,
+               high.y, high.c, high.nInvalid);
+    }
+    else                                                               /* a low and a high column for each count */
+        printf(",%s,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld",
+               estimated ? "true" : "false", low.nWords, high.nWords, low.a, high.a, low.e, high.e, low.i, high.i,
+               low.o, high.o, low.u, high.u, low.y, high.y, low.c, high.c, low.nInvalid, high.nInvalid);
+}
+
+/**
+ *  \brief Print the results of a file, as soon as it is complete.
+ *
+ *  Internal monitor operation.
+ *
+ *  \param i file identification
+ */
+static void printFileResults(int i)
+{
+    switch (outFormat)
+    {
+        case OUT_NONE:
+            break;
+        case OUT_JSON:
+            if (failed[i])
+            {
+                printf("{\"file\": ");
+                printQuoted(fNames[i]);
+                printf(", \"error\": \"not processed\"}\n");
+                break;
+            }
+            printf("{\"file\": ");
+            printQuoted(fNames[i]);
+            printf(", \"words\": %lld, \"a\": %lld, \"e\": %lld, \"i\": %lld, \"o\": %lld, \"u\": %lld, \"y\": %lld, "
+                   "\"c\": %lld, \"invalid\": %lld", mem[i].nWords, mem[i].a, mem[i].e, mem[i].i, mem[i].o, mem[i].u,
+                   mem[i].y, mem[i].c, mem[i].nInvalid);
+            if (samplePrecision > 0.0) printBounds(i);
+            if (nPatterns > 0) printPatternCounts(i);
+            printf("}\n");
+            break;
+        case OUT_CSV:
+            printQuoted(fNames[i]);
+            if (failed[i])
+            {
+                printf(",,,,,,,,,");
+                if (samplePrecision > 0.0) printf(",,,,,,,,,,,,,,,,,,,");
+                for (int p = 0; p < nPatterns; p++)
+                    putchar(',');
+                putchar('\n');
+                break;
+            }
+            printf(",%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld", mem[i].nWords, mem[i].a, mem[i].e, mem[i].i,
+                   mem[i].o, mem[i].u, mem[i].y, mem[i].c, mem[i].nInvalid);
+            if (samplePrecision > 0.0) printBounds(i);
+            if (nPatterns > 0) printPatternCounts(i);
+            putchar('\n');
+            break;
+        default:
+            printf("\nFile name: %s:\n", fNames[i]);
+            if (failed[i])
+            {
+                printf("Not processed\n");
+                break;
+            }
+            printf("Total number of words = %lld\n", mem[i].nWords);
+            printf("N. of words witn an\n");
+            printf("\tA\tE\tI\tO\tU\tY\tC\n");
+            printf("\t%lld\t%lld\t%lld\t%lld\t%lld\t%lld\t%lld\n", mem[i].a, mem[i].e, mem[i].i, mem[i].o, mem[i].u,
+                   mem[i].y, mem[i].c);
+            if (mem[i].nInvalid > 0) printf("Invalid UTF-8 sequences = %lld\n", mem[i].nInvalid);
+            if (nPatterns > 0) printPatternCounts(i);
+    }
+    fflush(stdout);                                               /* let the downstream stages see it right away */
+    printed[i] = true;
+    if (copyOf == NULL || copyOf[i] != -1) return;
+    for (int j = nextCopy[i]; j != -1; j = nextCopy[j])                         /* its copies are complete too */
+    {
+        int *counts = mem[j].patternCounts;                               /* keep the storage of the copy */
+        mem[j] = mem[i];
+        mem[j].fileID = j;
+        mem[j].patternCounts = counts;
+        if (counts != NULL)
+            for (int p = 0; p < nPatterns; p++)
+                counts[p] = mem[i].patternCounts[p];
+        failed[j] = failed[i];
+        printFileResults(j);
+    }
 }
 
 /**
@@ -74,6 +303,22 @@ void storeFileNames(unsigned int threadID, int numFiles, char *fileNames[])
      
     nFiles = numFiles; /* Store values on the shared region */
     fNames = fileNames;
+    nextFile = 0;
+    fileOrder = NULL;
+    pthread_once (&init, initialization);
+    if (outFormat == OUT_CSV)                                /* the header, with a quoted column for each pattern */
+    {
+        printf("file,words,a,e,i,o,u,y,c,invalid");
+        if (samplePrecision > 0.0)                  /* whether each file was estimated, and the bounds of its counts */
+            printf(",estimated,words_low,words_high,a_low,a_high,e_low,e_high,i_low,i_high,o_low,o_high,u_low,u_high,"
+                   "y_low,y_high,c_low,c_high,invalid_low,invalid_high");
+        for (int p = 0; p < nPatterns; p++)
+        {
+            putchar(',');
+            printQuoted(patternNames[p]);
+        }
+        putchar('\n');
+    }
 
     if ((statusMain[threadID] = pthread_mutex_unlock (&accessCR)) != 0)       /* exit monitor */
      { errno = statusMain[threadID];                     /* save error in errno */
@@ -84,7 +329,244 @@ void storeFileNames(unsigned int threadID, int numFiles, char *fileNames[])
 }
 
 /**
- *  \brief Print the processing results.
+ *  \brief Store the number of chunks of a file, once it was completely read.
+ *
+ *  The results of the file are printed if all its chunks were already counted.
+ *
+ *  \param threadID thread identification
+ *  \param fileID file identification
+ *  \param nChunks number of chunks the file was split in
+ *
+ */
+void storeFileChunks(unsigned int threadID, int fileID, int nChunks)
+{
+    if ((statusMain[threadID] = pthread_mutex_lock (&accessCR)) != 0)       /* enter monitor */
+     { errno = statusMain[threadID];                                  /* save error in errno */
+       perror ("error on entering monitor(CF)");
+         statusMain[threadID] = EXIT_FAILURE;
+       pthread_exit (&statusMain[threadID]);
+     }
+
+    chunksExpected[fileID] = nChunks;
+    if (chunksDone[fileID] == nChunks) printFileResults(fileID);      /* all chunks were already counted */
+
+    if ((statusMain[threadID] = pthread_mutex_unlock (&accessCR)) != 0)       /* exit monitor */
+     { errno = statusMain[threadID];                     /* save error in errno */
+       perror ("error on exiting monitor(CF)");
+         statusMain[threadID] = EXIT_FAILURE;
+       pthread_exit (&statusMain[threadID]);
+     }
+}
+
+/**
+ *  \brief Store the order in which the files are to be counted whole by the workers.
+ *
+ *  \param threadID thread identification
+ *  \param order identifications of the files, in order (NULL for the order they were stored in)
+ *
+ */
+void storeFileOrder(unsigned int threadID, int *order)
+{
+    if ((statusMain[threadID] = pthread_mutex_lock (&accessCR)) != 0)       /* enter monitor */
+     { errno = statusMain[threadID];                                  /* save error in errno */
+       perror ("error on entering monitor(CF)");
+         statusMain[threadID] = EXIT_FAILURE;
+       pthread_exit (&statusMain[threadID]);
+     }
+
+    fileOrder = order;
+
+    if ((statusMain[threadID] = pthread_mutex_unlock (&accessCR)) != 0)       /* exit monitor */
+     { errno = statusMain[threadID];                     /* save error in errno */
+       perror ("error on exiting monitor(CF)");
+         statusMain[threadID] = EXIT_FAILURE;
+       pthread_exit (&statusMain[threadID]);
+     }
+}
+
+/**
+ *  \brief Store which files are copies of an earlier one, and must not be counted.
+ *
+ *  A copy gets the results of its file as soon as that file is complete.
+ *
+ *  \param threadID thread identification
+ *  \param sameAs earliest file with the same contents as each file, or -1 if there is none
+ *
+ */
+void storeFileCopies(unsigned int threadID, int *sameAs)
+{
+    if ((statusMain[threadID] = pthread_mutex_lock (&accessCR)) != 0)       /* enter monitor */
+     { errno = statusMain[threadID];                                  /* save error in errno */
+       perror ("error on entering monitor(CF)");
+         statusMain[threadID] = EXIT_FAILURE;
+       pthread_exit (&statusMain[threadID]);
+     }
+
+    if ((nextCopy = (int*) malloc(sizeof(int)*(nFiles + 1))) == NULL)
+    { fprintf (stderr, "error on allocating space to the copies of the files\n");
+      exit (EXIT_FAILURE);
+    }
+    copyOf = sameAs;
+    for (int i = 0; i < nFiles; ++i)
+        nextCopy[i] = -1;
+    for (int i = nFiles - 1; i >= 0; --i)                      /* chain the copies of each file, in order */
+    {
+        if (sameAs[i] != -1)
+        {
+            nextCopy[i] = nextCopy[sameAs[i]];
+            nextCopy[sameAs[i]] = i;
+        }
+    }
+
+    if ((statusMain[threadID] = pthread_mutex_unlock (&accessCR)) != 0)       /* exit monitor */
+     { errno = statusMain[threadID];                     /* save error in errno */
+       perror ("error on exiting monitor(CF)");
+         statusMain[threadID] = EXIT_FAILURE;
+       pthread_exit (&statusMain[threadID]);
+     }
+}
+
+/**
+ *  \brief Get the next file to be counted whole by a worker.
+ *
+ *  \param threadID thread identification
+ *
+ *  \return file identification, or -1 if all files were already taken
+ */
+int getNextFile(unsigned int threadID)
+{
+    if ((statusWorkers[threadID] = pthread_mutex_lock (&accessCR)) != 0)       /* enter monitor */
+     { errno = statusWorkers[threadID];                                  /* save error in errno */
+       perror ("error on entering monitor(CF)");
+         statusWorkers[threadID] = EXIT_FAILURE;
+       pthread_exit (&statusWorkers[threadID]);
+     }
+
+    int fileID = -1;
+    while (fileID == -1 && nextFile < nFiles)
+    {
+        fileID = (fileOrder != NULL) ? fileOrder[nextFile] : nextFile;
+        nextFile += 1;
+        if (copyOf != NULL && copyOf[fileID] != -1) fileID = -1;              /* a copy is not counted */
+    }
+
+    if ((statusWorkers[threadID] = pthread_mutex_unlock (&accessCR)) != 0)       /* exit monitor */
+     { errno = statusWorkers[threadID];                     /* save error in errno */
+       perror ("error on exiting monitor(CF)");
+         statusWorkers[threadID] = EXIT_FAILURE;
+       pthread_exit (&statusWorkers[threadID]);
+     }
+
+    return fileID;
+}
+
+/**
+ *  \brief Store the results of a whole file, counted by a single worker.
+ *
+ *  \param threadID thread identification
+ *  \param fileID file identification
+ *  \param results results of the file, or NULL if it could not be processed
+ *
+ */
+void saveFileResults(unsigned int threadID, int fileID, TempResults *results)
+{
+    if ((statusWorkers[threadID] = pthread_mutex_lock (&accessCR)) != 0)       /* enter monitor */
+     { errno = statusWorkers[threadID];                                  /* save error in errno */
+       perror ("error on entering monitor(CF)");
+         statusWorkers[threadID] = EXIT_FAILURE;
+       pthread_exit (&statusWorkers[threadID]);
+     }
+
+    if (results == NULL) failed[fileID] = true;
+    else
+    {
+        int *counts = mem[fileID].patternCounts;                          /* keep the storage of the file */
+        results->fileID = fileID;
+        mem[fileID] = *results;
+        mem[fileID].patternCounts = counts;
+        if (counts != NULL && results->patternCounts != NULL)
+            for (int p = 0; p < nPatterns; p++)
+                counts[p] = results->patternCounts[p];
+    }
+    printFileResults(fileID);
+
+    if ((statusWorkers[threadID] = pthread_mutex_unlock (&accessCR)) != 0)       /* exit monitor */
+     { errno = statusWorkers[threadID];                     /* save error in errno */
+       perror ("error on exiting monitor(CF)");
+         statusWorkers[threadID] = EXIT_FAILURE;
+       pthread_exit (&statusWorkers[threadID]);
+     }
+}
+
+/**
+ *  \brief Signal a file could not be processed.
+ *
+ *  The failure is printed in place of the results of the file.
+ *
+ *  \param threadID thread identification
+ *  \param fileID file identification
+ *
+ */
+void storeFileFailure(unsigned int threadID, int fileID)
+{
+    if ((statusMain[threadID] = pthread_mutex_lock (&accessCR)) != 0)       /* enter monitor */
+     { errno = statusMain[threadID];                                  /* save error in errno */
+       perror ("error on entering monitor(CF)");
+         statusMain[threadID] = EXIT_FAILURE;
+       pthread_exit (&statusMain[threadID]);
+     }
+
+    failed[fileID] = true;
+    printFileResults(fileID);
+
+    if ((statusMain[threadID] = pthread_mutex_unlock (&accessCR)) != 0)       /* exit monitor */
+     { errno = statusMain[threadID];                     /* save error in errno */
+       perror ("error on exiting monitor(CF)");
+         statusMain[threadID] = EXIT_FAILURE;
+       pthread_exit (&statusMain[threadID]);
+     }
+}
+
+/**
+ *  \brief Get the results of a file.
+ *
+ *  \param threadID thread identification
+ *  \param fileID file identification
+ *  \param res returns the results of the file (the occurrences of the patterns are copied to the array of the
+ *         caller, if any)
+ *
+ *  \return true if the file was processed
+ */
+bool getFileResults(unsigned int threadID, int fileID, TempResults *res)
+{
+    if ((statusMain[threadID] = pthread_mutex_lock (&accessCR)) != 0)       /* enter monitor */
+     { errno = statusMain[threadID];                                  /* save error in errno */
+       perror ("error on entering monitor(CF)");
+         statusMain[threadID] = EXIT_FAILURE;
+       pthread_exit (&statusMain[threadID]);
+     }
+
+    int *counts = res->patternCounts;
+    *res = mem[fileID];
+    res->fileID = fileID;
+    res->patternCounts = counts;
+    if (counts != NULL && mem[fileID].patternCounts != NULL)     /* the occurrences, if the caller wants them */
+        for (int p = 0; p < nPatterns; p++)
+            counts[p] = mem[fileID].patternCounts[p];
+    bool processed = !failed[fileID];
+
+    if ((statusMain[threadID] = pthread_mutex_unlock (&accessCR)) != 0)       /* exit monitor */
+     { errno = statusMain[threadID];                     /* save error in errno */
+       perror ("error on exiting monitor(CF)");
+         statusMain[threadID] = EXIT_FAILURE;
+       pthread_exit (&statusMain[threadID]);
+     }
+
+    return processed;
+}
+
+/**
+ *  \brief Print the processing results of the files not printed yet.
  *
  *  \param threadID thread identification
  *
@@ -97,15 +579,9 @@ void printProcessingResults(unsigned int threadID)
         statusMain[threadID] = EXIT_FAILURE;
         pthread_exit (&statusMain[threadID]);
     }
-    for (int i = 0; i < nFiles; ++i) {
-        printf("\nFile name: %s:\n", fNames[i]);
-        printf("Total number of words = %d\n", mem[i].nWords);
-        printf("N. of words witn an\n");
-        printf("\tA\tE\tI\tO\tU\tY\tC\n");
-        printf("\t%d\t%d\t%d\t%d\t%d\t%d\t%d\n", mem[i].a, mem[i].e, mem[i].i, mem[i].o, mem[i].u, mem[i].y, mem[i].c);
-    }
-
-
+    pthread_once (&init, initialization);
+    for (int i = 0; i < nFiles; ++i)
+        if (!printed[i]) printFileResults(i);
 
     if ((statusMain[threadID] = pthread_mutex_unlock (&accessCR)) != 0)       /* exit monitor */
     { errno = statusMain[threadID];                     /* save error in errno */
@@ -139,6 +615,23 @@ void savePartialResults(unsigned int threadID, TempResults *partialResults)
     mem[partialResults->fileID].u += partialResults->u;
     mem[partialResults->fileID].c += partialResults->c;
     mem[partialResults->fileID].y += partialResults->y;
+    mem[partialResults->fileID].nInvalid += partialResults->nInvalid;
+    if (mem[partialResults->fileID].patternCounts != NULL && partialResults->patternCounts != NULL)
+        for (int p = 0; p < nPatterns; p++)
+            mem[partialResults->fileID].patternCounts[p] += partialResults->patternCounts[p];
+    chunksDone[partialResults->fileID] += 1;
+    totalDone += 1;
+    if (totalDone == totalWanted)                                      /* let the producer know it may go on */
+    {
+        if ((statusWorkers[threadID] = pthread_cond_signal (&allCounted)) != 0)
+         { errno = statusWorkers[threadID];                                  /* save error in errno */
+           perror ("error on signaling in allCounted");
+             statusWorkers[threadID] = EXIT_FAILURE;
+           pthread_exit (&statusWorkers[threadID]);
+         }
+    }
+    if (chunksDone[partialResults->fileID] == chunksExpected[partialResults->fileID])      /* last chunk of the file */
+        printFileResults(partialResults->fileID);
 
     if ((statusWorkers[threadID] = pthread_mutex_unlock (&accessCR)) != 0)       /* exit monitor */
      { errno = statusWorkers[threadID];                     /* save error in errno */
@@ -148,3 +641,77 @@ void savePartialResults(unsigned int threadID, TempResults *partialResults)
      }
 }
 
+
+/**
+ *  \brief Store the results of part of a file, counted by an earlier run.
+ *
+ *  They are added to the results of the file without counting as a chunk.
+ *
+ *  \param threadID thread identification
+ *  \param results results of the part of the file
+ */
+void storeResumedResults(unsigned int threadID, TempResults *results)
+{
+    if ((statusMain[threadID] = pthread_mutex_lock (&accessCR)) != 0)       /* enter monitor */
+     { errno = statusMain[threadID];                                  /* save error in errno */
+       perror ("error on entering monitor(CF)");
+         statusMain[threadID] = EXIT_FAILURE;
+       pthread_exit (&statusMain[threadID]);
+     }
+
+    TempResults *res = &mem[results->fileID];
+    res->nWords += results->nWords;
+    res->a += results->a;
+    res->e += results->e;
+    res->i += results->i;
+    res->o += results->o;
+    res->u += results->u;
+    res->c += results->c;
+    res->y += results->y;
+    res->nInvalid += results->nInvalid;
+    if (res->patternCounts != NULL && results->patternCounts != NULL)
+        for (int p = 0; p < nPatterns; p++)
+            res->patternCounts[p] += results->patternCounts[p];
+
+    if ((statusMain[threadID] = pthread_mutex_unlock (&accessCR)) != 0)       /* exit monitor */
+     { errno = statusMain[threadID];                     /* save error in errno */
+       perror ("error on exiting monitor(CF)");
+         statusMain[threadID] = EXIT_FAILURE;
+       pthread_exit (&statusMain[threadID]);
+     }
+}
+
+/**
+ *  \brief Wait until a number of chunks, of all files, were counted.
+ *
+ *  \param threadID thread identification
+ *  \param nChunks number of chunks stored in the data transfer region so far
+ */
+void waitChunksCounted(unsigned int threadID, int nChunks)
+{
+    if ((statusMain[threadID] = pthread_mutex_lock (&accessCR)) != 0)       /* enter monitor */
+     { errno = statusMain[threadID];                                  /* save error in errno */
+       perror ("error on entering monitor(CF)");
+         statusMain[threadID] = EXIT_FAILURE;
+       pthread_exit (&statusMain[threadID]);
+     }
+
+    totalWanted = nChunks;
+    while (totalDone < nChunks)                                    /* wait if some chunk is not counted yet */
+    {
+        if ((statusMain[threadID] = pthread_cond_wait (&allCounted, &accessCR)) != 0)
+         { errno = statusMain[threadID];                                  /* save error in errno */
+           perror ("error on waiting in allCounted");
+             statusMain[threadID] = EXIT_FAILURE;
+           pthread_exit (&statusMain[threadID]);
+         }
+    }
+    totalWanted = -1;
+
+    if ((statusMain[threadID] = pthread_mutex_unlock (&accessCR)) != 0)       /* exit monitor */
+     { errno = statusMain[threadID];                     /* save error in errno */
+       perror ("error on exiting monitor(CF)");
+         statusMain[threadID] = EXIT_FAILURE;
+       pthread_exit (&statusMain[threadID]);
+     }
+}
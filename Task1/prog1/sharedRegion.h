@@ -7,7 +7,21 @@
  */
 #ifndef SHAREDREGION_H
 #define SHAREDREGION_H
+#include <stdbool.h>
 #include "dataStructures.h"
+
+/** \brief results printed as the text report */
+#define OUT_TEXT    0
+
+/** \brief results printed as JSON Lines, one object per file */
+#define OUT_JSON    1
+
+/** \brief results printed as CSV, one row per file */
+#define OUT_CSV     2
+
+/** \brief results only gathered, not printed */
+#define OUT_NONE    3
+
 /**
  *  \brief Initializes the data transfer region.
  *
@@ -25,7 +39,81 @@ void initialization (void);
 void storeFileNames(unsigned int threadID, int numFiles, char *fileNames[]);
 
 /**
- *  \brief Print the processing results.
+ *  \brief Store the number of chunks of a file, once it was completely read.
+ *
+ *  The results of the file are printed if all its chunks were already counted.
+ *
+ *  \param threadID thread identification
+ *  \param fileID file identification
+ *  \param nChunks number of chunks the file was split in
+ *
+ */
+void storeFileChunks(unsigned int threadID, int fileID, int nChunks);
+
+/**
+ *  \brief Store the order in which the files are to be counted whole by the workers.
+ *
+ *  \param threadID thread identification
+ *  \param order identifications of the files, in order (NULL for the order they were stored in)
+ *
+ */
+void storeFileOrder(unsigned int threadID, int *order);
+
+/**
+ *  \brief Store which files are copies of an earlier one, and must not be counted.
+ *
+ *  A copy gets the results of its file as soon as that file is complete.
+ *
+ *  \param threadID thread identification
+ *  \param sameAs earliest file with the same contents as each file, or -1 if there is none
+ *
+ */
+void storeFileCopies(unsigned int threadID, int *sameAs);
+
+/**
+ *  \brief Get the next file to be counted whole by a worker.
+ *
+ *  \param threadID thread identification
+ *
+ *  \return file identification, or -1 if all files were already taken (copies of other files are never taken)
+ */
+int getNextFile(unsigned int threadID);
+
+/**
+ *  \brief Store the results of a whole file, counted by a single worker.
+ *
+ *  \param threadID thread identification
+ *  \param fileID file identification
+ *  \param results results of the file, or NULL if it could not be processed
+ *
+ */
+void saveFileResults(unsigned int threadID, int fileID, TempResults *results);
+
+/**
+ *  \brief Signal a file could not be processed.
+ *
+ *  The failure is printed in place of the results of the file.
+ *
+ *  \param threadID thread identification
+ *  \param fileID file identification
+ *
+ */
+void storeFileFailure(unsigned int threadID, int fileID);
+
+/**
+ *  \brief Get the results of a file.
+ *
+ *  \param threadID thread identification
+ *  \param fileID file identification
+ *  \param res returns the results of the file (the occurrences of the patterns are copied to the array of the
+ *         caller, if any)
+ *
+ *  \return true if the file was processed
+ */
+bool getFileResults(unsigned int threadID, int fileID, TempResults *res);
+
+/**
+ *  \brief Print the processing results of the files not printed yet.
  *
  *  \param threadID thread identification
  *
@@ -40,4 +128,22 @@ void printProcessingResults(unsigned int threadID);
  */
 void savePartialResults(unsigned int threadID, TempResults *partialResults);
 
+/**
+ *  \brief Store the results of part of a file, counted by an earlier run.
+ *
+ *  They are added to the results of the file without counting as a chunk.
+ *
+ *  \param threadID thread identification
+ *  \param results results of the part of the file
+ */
+void storeResumedResults(unsigned int threadID, TempResults *results);
+
+/**
+ *  \brief Wait until a number of chunks, of all files, were counted.
+ *
+ *  \param threadID thread identification
+ *  \param nChunks number of chunks stored in the data transfer region so far
+ */
+void waitChunksCounted(unsigned int threadID, int nChunks);
+
 #endif /* SHAREDREGION_H */
\ No newline at end of file
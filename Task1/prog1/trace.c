@@ -0,0 +1,236 @@
+/**
+ *  \file trace.c (implementation file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Tracing of the chunk life cycle, exported in the Chrome trace event format (readable by chrome://tracing and
+ *  Perfetto).
+ *
+ *  Definition of the operations:
+ *     \li traceInit
+ *     \li traceName
+ *     \li traceNow
+ *     \li traceEvent
+ *     \li traceFlow
+ *     \li traceWrite.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "trace.h"
+
+/**
+ * \brief Struct to store a trace event
+ */
+typedef struct
+{
+  char phase;                                  /* 'X' for a complete event, or the phase of a flow point */
+  const char *name;
+  double start;
+  double duration;
+  int fileID;
+  int index;
+  int numBytes;
+} TraceEvent;
+
+/**
+ * \brief Struct to store the events of a thread, written only by that thread
+ */
+typedef struct
+{
+  const char *role;
+  int index;
+  TraceEvent *events;
+  int nEvents;
+  int capacity;
+} TraceBuffer;
+
+/** \brief flag signaling events are being recorded */
+bool tracing = false;
+
+/** \brief buffer of each thread */
+static TraceBuffer *buffers;
+
+/** \brief number of trace slots */
+static int nSlots;
+
+/** \brief time the trace started */
+static struct timespec t0;
+
+/**
+ *  \brief Start recording events.
+ *
+ *  Must be called before the worker threads are created.
+ *
+ *  \param nWorkers number of worker threads
+ */
+
+void traceInit (int nWorkers)
+{
+  nSlots = nWorkers + 1;
+  if ((buffers = calloc (nSlots, sizeof (TraceBuffer))) == NULL)
+     { fprintf (stderr, "error on allocating space to the trace buffers\n");
+       exit (EXIT_FAILURE);
+     }
+  buffers[TRACE_MAIN].role = "main";
+  buffers[TRACE_MAIN].index = -1;
+  for (int s = 1; s < nSlots; s++)
+  { buffers[s].role = "worker";
+    buffers[s].index = s - 1;
+  }
+  clock_gettime (CLOCK_MONOTONIC, &t0);
+  tracing = true;
+}
+
+/**
+ *  \brief Name the thread of a trace slot, as a role and a number (by default "main" and "worker k").
+ *
+ *  Must be called before the thread records any event.
+ *
+ *  \param slot trace slot of the thread
+ *  \param role role of the thread (a string constant)
+ *  \param index number of the thread among those of its role
+ */
+
+void traceName (int slot, const char *role, int index)
+{
+  if (!tracing || (slot >= nSlots)) return;
+  buffers[slot].role = role;
+  buffers[slot].index = index;
+}
+
+/**
+ *  \brief Get the current time of the trace.
+ *
+ *  \return microseconds since the trace started, or 0 if no events are being recorded
+ */
+
+double traceNow (void)
+{
+  struct timespec t;
+
+  if (!tracing) return 0.0;
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return 1.0e6 * (double) (t.tv_sec - t0.tv_sec) + 1.0e-3 * (double) (t.tv_nsec - t0.tv_nsec);
+}
+
+/**
+ *  \brief Get room for a new event in the buffer of a thread.
+ *
+ *  Internal operation.
+ *
+ *  \param slot trace slot of the calling thread
+ *
+ *  \return pointer to the new event, or NULL if it must be dropped
+ */
+
+static TraceEvent *newEvent (int slot)
+{
+  if (!tracing || (slot >= nSlots)) return NULL;
+
+  TraceBuffer *buf = &buffers[slot];
+  if (buf->nEvents == buf->capacity)
+     { int capacity = (buf->capacity == 0) ? 1024 : 2 * buf->capacity;
+       TraceEvent *events;
+       if ((events = realloc (buf->events, capacity * sizeof (TraceEvent))) == NULL) return NULL;
+       buf->events = events;
+       buf->capacity = capacity;
+     }
+  return &buf->events[buf->nEvents++];
+}
+
+/**
+ *  \brief Record an event which started at a given time and ends now.
+ *
+ *  \param slot trace slot of the calling thread
+ *  \param name name of the event (a string constant)
+ *  \param start time the event started, as returned by traceNow
+ *  \param fileID file the event refers to, or -1 if it does not refer to a single file
+ *  \param index index in the file of the chunk the event refers to, or -1 if it does not refer to a single chunk
+ *  \param numBytes number of bytes the event refers to
+ */
+
+void traceEvent (int slot, const char *name, double start, int fileID, int index, int numBytes)
+{
+  TraceEvent *ev;
+
+  if ((ev = newEvent (slot)) == NULL) return;                                                 /* drop the event */
+  ev->phase = 'X';
+  ev->name = name;
+  ev->start = start;
+  ev->duration = traceNow () - start;
+  ev->fileID = fileID;
+  ev->index = index;
+  ev->numBytes = numBytes;
+}
+
+/**
+ *  \brief Record the handoff of a chunk between threads, as a point of its flow.
+ *
+ *  Must be called while the event that puts (or gets) the chunk is going on, so that the flow binds to it.
+ *
+ *  \param slot trace slot of the calling thread
+ *  \param fileID file of the chunk
+ *  \param index index of the chunk in the file
+ *  \param phase TRACE_PUT where the chunk is first put, TRACE_STEP where it is got and put again, TRACE_GET where
+ *         it is got for the last time
+ */
+
+void traceFlow (int slot, int fileID, int index, char phase)
+{
+  TraceEvent *ev;
+
+  if ((ev = newEvent (slot)) == NULL) return;                                                 /* drop the event */
+  ev->phase = phase;
+  ev->name = "chunk";
+  ev->start = traceNow ();
+  ev->duration = 0.0;
+  ev->fileID = fileID;
+  ev->index = index;
+  ev->numBytes = 0;
+}
+
+/**
+ *  \brief Write the recorded events as a Chrome trace event JSON file.
+ *
+ *  \param path name of the trace file
+ */
+
+void traceWrite (const char *path)
+{
+  FILE *fp;
+
+  if (!tracing) return;
+  if ((fp = fopen (path, "w")) == NULL)
+     { perror (path);
+       return;
+     }
+  fprintf (fp, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+  for (int s = 0; s < nSlots; s++)
+  { fprintf (fp, "%s{\"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"name\": \"thread_name\", \"args\": {\"name\": \"%s",
+             (s == 0) ? "" : ",\n", s, buffers[s].role);
+    if (buffers[s].index >= 0) fprintf (fp, " %d", buffers[s].index);
+    fprintf (fp, "\"}}");
+    for (int e = 0; e < buffers[s].nEvents; e++)
+    { TraceEvent *ev = &buffers[s].events[e];
+      if (ev->phase != 'X')                                /* a flow point: the id is the file and the chunk index */
+         { fprintf (fp, ",\n{\"ph\": \"%c\", \"pid\": 1, \"tid\": %d, \"name\": \"%s\", \"cat\": \"chunk\", "
+                    "\"id\": \"%d.%d\", \"ts\": %.3f%s}", ev->phase, s, ev->name, ev->fileID, ev->index, ev->start,
+                    (ev->phase != TRACE_PUT) ? ", \"bp\": \"e\"" : "");
+           continue;
+         }
+      fprintf (fp, ",\n{\"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"name\": \"%s\", \"ts\": %.3f, \"dur\": %.3f, "
+               "\"args\": {", s, ev->name, ev->start, ev->duration);
+      if (ev->fileID >= 0) fprintf (fp, "\"file\": %d, ", ev->fileID);
+      if (ev->index >= 0) fprintf (fp, "\"chunk\": %d, ", ev->index);
+      fprintf (fp, "\"bytes\": %d}}", ev->numBytes);
+    }
+  }
+  fprintf (fp, "\n]}\n");
+  fclose (fp);
+}
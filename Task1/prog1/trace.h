@@ -0,0 +1,97 @@
+/**
+ *  \file trace.h (interface file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Tracing of the chunk life cycle, exported in the Chrome trace event format (readable by chrome://tracing and
+ *  Perfetto).
+ *
+ *  Each thread records its events in its own buffer, so recording needs no synchronization.
+ *
+ *  A chunk is identified by its file and its index in the file. A chunk handed from one thread to another is linked
+ *  by a flow event, from the event which put it to the event which got it. The time a thread waits on a full or
+ *  empty queue is recorded as an event of its own.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+
+/** \brief trace slot of the main (producer) thread; worker i uses slot i + 1 */
+#define TRACE_MAIN    0
+
+/** \brief flow point where a chunk is first put */
+#define TRACE_PUT     's'
+
+/** \brief flow point where a chunk is got and put again */
+#define TRACE_STEP    't'
+
+/** \brief flow point where a chunk is got for the last time */
+#define TRACE_GET     'f'
+
+/** \brief flag signaling events are being recorded */
+extern bool tracing;
+
+/**
+ *  \brief Start recording events.
+ *
+ *  Must be called before the worker threads are created.
+ *
+ *  \param nWorkers number of worker threads
+ */
+extern void traceInit (int nWorkers);
+
+/**
+ *  \brief Name the thread of a trace slot, as a role and a number (by default "main" and "worker k").
+ *
+ *  Must be called before the thread records any event.
+ *
+ *  \param slot trace slot of the thread
+ *  \param role role of the thread (a string constant)
+ *  \param index number of the thread among those of its role
+ */
+extern void traceName (int slot, const char *role, int index);
+
+/**
+ *  \brief Get the current time of the trace.
+ *
+ *  \return microseconds since the trace started, or 0 if no events are being recorded
+ */
+extern double traceNow (void);
+
+/**
+ *  \brief Record an event which started at a given time and ends now.
+ *
+ *  \param slot trace slot of the calling thread
+ *  \param name name of the event (a string constant)
+ *  \param start time the event started, as returned by traceNow
+ *  \param fileID file the event refers to, or -1 if it does not refer to a single file
+ *  \param index index in the file of the chunk the event refers to, or -1 if it does not refer to a single chunk
+ *  \param numBytes number of bytes the event refers to
+ */
+extern void traceEvent (int slot, const char *name, double start, int fileID, int index, int numBytes);
+
+/**
+ *  \brief Record the handoff of a chunk between threads, as a point of its flow.
+ *
+ *  Must be called while the event that puts (or gets) the chunk is going on, so that the flow binds to it.
+ *
+ *  \param slot trace slot of the calling thread
+ *  \param fileID file of the chunk
+ *  \param index index of the chunk in the file
+ *  \param phase TRACE_PUT where the chunk is first put, TRACE_STEP where it is got and put again, TRACE_GET where
+ *         it is got for the last time
+ */
+extern void traceFlow (int slot, int fileID, int index, char phase);
+
+/**
+ *  \brief Write the recorded events as a Chrome trace event JSON file.
+ *
+ *  \param path name of the trace file
+ */
+extern void traceWrite (const char *path);
+
+#endif /* TRACE_H */
@@ -0,0 +1,189 @@
+/**
+ *  \file utf8.c (implementation file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  UTF-8 validation, decoding and canonical composition (NFC) of the Portuguese diacritics.
+ *
+ *  Definition of the operations carried out by the producer / workers:
+ *     \li utf8SeqLen
+ *     \li utf8Decode
+ *     \li decodeChunk.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "utf8.h"
+
+/** \brief Windows-1252 code points of the bytes 0x80 to 0x9F (the remaining bytes map to Latin-1) */
+static const int cp1252[32] = {
+  0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+  0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+  0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+  0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178
+};
+
+/** \brief Struct to store a canonical composition: base letter + combining mark = precomposed letter */
+typedef struct
+{
+  int base;
+  int mark;
+  int composed;
+} Composition;
+
+/** \brief canonical compositions of the Latin-1 letters */
+static const Composition compositions[] = {
+  {'A', 0x300, 0xC0}, {'E', 0x300, 0xC8}, {'I', 0x300, 0xCC}, {'O', 0x300, 0xD2}, {'U', 0x300, 0xD9},
+  {'a', 0x300, 0xE0}, {'e', 0x300, 0xE8}, {'i', 0x300, 0xEC}, {'o', 0x300, 0xF2}, {'u', 0x300, 0xF9},
+  {'A', 0x301, 0xC1}, {'E', 0x301, 0xC9}, {'I', 0x301, 0xCD}, {'O', 0x301, 0xD3}, {'U', 0x301, 0xDA},
+  {'Y', 0x301, 0xDD},
+  {'a', 0x301, 0xE1}, {'e', 0x301, 0xE9}, {'i', 0x301, 0xED}, {'o', 0x301, 0xF3}, {'u', 0x301, 0xFA},
+  {'y', 0x301, 0xFD},
+  {'A', 0x302, 0xC2}, {'E', 0x302, 0xCA}, {'I', 0x302, 0xCE}, {'O', 0x302, 0xD4}, {'U', 0x302, 0xDB},
+  {'a', 0x302, 0xE2}, {'e', 0x302, 0xEA}, {'i', 0x302, 0xEE}, {'o', 0x302, 0xF4}, {'u', 0x302, 0xFB},
+  {'A', 0x303, 0xC3}, {'N', 0x303, 0xD1}, {'O', 0x303, 0xD5},
+  {'a', 0x303, 0xE3}, {'n', 0x303, 0xF1}, {'o', 0x303, 0xF5},
+  {'A', 0x308, 0xC4}, {'E', 0x308, 0xCB}, {'I', 0x308, 0xCF}, {'O', 0x308, 0xD6}, {'U', 0x308, 0xDC},
+  {'a', 0x308, 0xE4}, {'e', 0x308, 0xEB}, {'i', 0x308, 0xEF}, {'o', 0x308, 0xF6}, {'u', 0x308, 0xFC},
+  {'y', 0x308, 0xFF},
+  {'C', 0x327, 0xC7}, {'c', 0x327, 0xE7}
+};
+
+/** \brief number of canonical compositions */
+static const int nCompositions = sizeof compositions / sizeof compositions[0];
+
+/**
+ *  \brief Compose a base letter with a combining mark.
+ *
+ *  Internal operation.
+ *
+ *  \param base base letter
+ *  \param mark combining mark
+ *
+ *  \return precomposed letter, or 0 if there is none
+ */
+
+static int compose (int base, int mark)
+{
+  for (int k = 0; k < nCompositions; k++)
+    if ((compositions[k].mark == mark) && (compositions[k].base == base))
+       return compositions[k].composed;
+  return 0;
+}
+
+/**
+ *  \brief Get the length of the UTF-8 sequence started by a lead byte.
+ *
+ *  \param lead first byte of the sequence
+ *
+ *  \return number of bytes of the sequence (1 to 4), or 0 if the byte can not start a sequence
+ */
+
+int utf8SeqLen (int lead)
+{
+  if (lead < 0x80) return 1;
+  if (lead < 0xC2) return 0;                                           /* continuation byte or overlong lead byte */
+  if (lead < 0xE0) return 2;
+  if (lead < 0xF0) return 3;
+  if (lead < 0xF5) return 4;
+  return 0;
+}
+
+/**
+ *  \brief Decode the code point starting at a given position of a byte buffer.
+ *
+ *  Malformed, overlong or truncated sequences consume a single byte, which is reinterpreted as Windows-1252
+ *  (the usual encoding of text that is not valid UTF-8).
+ *
+ *  \param in byte buffer
+ *  \param n number of bytes in the buffer
+ *  \param pos position of the first byte, advanced past the decoded sequence
+ *  \param invalid set to true if the sequence was not valid UTF-8
+ *
+ *  \return decoded code point
+ */
+
+int utf8Decode (const unsigned char *in, int n, int *pos, bool *invalid)
+{
+  int lead = in[*pos];
+  int len = utf8SeqLen (lead);
+  int cp;
+
+  *invalid = false;
+  if (len == 1)
+     { (*pos)++;
+       return lead;
+     }
+  if ((len != 0) && (*pos + len <= n))
+     { cp = lead & (0x7F >> len);
+       int k;
+       for (k = 1; k < len; k++)
+       { if ((in[*pos + k] & 0xC0) != 0x80) break;                                 /* not a continuation byte */
+         cp = (cp << 6) | (in[*pos + k] & 0x3F);
+       }
+       if ((k == len) &&
+           !((len == 3) && (cp < 0x800)) &&                                                         /* overlong */
+           !((len == 3) && (cp >= 0xD800) && (cp <= 0xDFFF)) &&                                    /* surrogate */
+           !((len == 4) && ((cp < 0x10000) || (cp > 0x10FFFF))))                         /* overlong or too big */
+          { *pos += len;
+            return cp;
+          }
+     }
+
+  *invalid = true;                                                           /* fall back to Windows-1252 */
+  (*pos)++;
+  return (lead < 0xA0) ? cp1252[lead - 0x80] : lead;
+}
+
+/**
+ *  \brief Decode a byte buffer into code points.
+ *
+ *  Runs of ASCII are copied eight bytes at a time; only the remaining bytes go through the full decoder.
+ *  Optionally a base letter followed by a combining diacritic is composed into the precomposed letter (NFC).
+ *
+ *  \param in byte buffer
+ *  \param n number of bytes in the buffer
+ *  \param cps array of at least n positions to store the code points
+ *  \param nfc flag signaling canonical composition should be applied
+ *  \param nInvalid number of invalid sequences found
+ *
+ *  \return number of code points stored
+ */
+
+int decodeChunk (const unsigned char *in, int n, int *cps, bool nfc, int *nInvalid)
+{
+  int p = 0;                                                                             /* position in the input */
+  int m = 0;                                                                          /* number of code points */
+  uint64_t block;                                                                 /* eight bytes of the input */
+  bool invalid;
+
+  *nInvalid = 0;
+  while (p < n)
+  { if (p + 8 <= n)                                                                            /* ASCII fast path */
+       { memcpy (&block, in + p, 8);
+         if ((block & 0x8080808080808080ULL) == 0)
+            { for (int k = 0; k < 8; k++)
+                cps[m + k] = in[p + k];
+              m += 8;
+              p += 8;
+              continue;
+            }
+       }
+    int cp = utf8Decode (in, n, &p, &invalid);
+    if (invalid) (*nInvalid)++;
+    if (nfc && (cp >= 0x300) && (cp <= 0x36F) && (m > 0))                         /* combining diacritical mark */
+       { int composed = compose (cps[m - 1], cp);
+         if (composed != 0)
+            { cps[m - 1] = composed;
+              continue;
+            }
+       }
+    cps[m++] = cp;
+  }
+  return m;
+}
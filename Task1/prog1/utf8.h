@@ -0,0 +1,61 @@
+/**
+ *  \file utf8.h (interface file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  UTF-8 validation, decoding and canonical composition (NFC) of the Portuguese diacritics.
+ *
+ *  Definition of the operations carried out by the producer / workers:
+ *     \li utf8SeqLen
+ *     \li utf8Decode
+ *     \li decodeChunk.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <stdbool.h>
+
+/**
+ *  \brief Get the length of the UTF-8 sequence started by a lead byte.
+ *
+ *  \param lead first byte of the sequence
+ *
+ *  \return number of bytes of the sequence (1 to 4), or 0 if the byte can not start a sequence
+ */
+extern int utf8SeqLen (int lead);
+
+/**
+ *  \brief Decode the code point starting at a given position of a byte buffer.
+ *
+ *  Malformed, overlong or truncated sequences consume a single byte, which is reinterpreted as Windows-1252
+ *  (the usual encoding of text that is not valid UTF-8).
+ *
+ *  \param in byte buffer
+ *  \param n number of bytes in the buffer
+ *  \param pos position of the first byte, advanced past the decoded sequence
+ *  \param invalid set to true if the sequence was not valid UTF-8
+ *
+ *  \return decoded code point
+ */
+extern int utf8Decode (const unsigned char *in, int n, int *pos, bool *invalid);
+
+/**
+ *  \brief Decode a byte buffer into code points.
+ *
+ *  Runs of ASCII are copied eight bytes at a time; only the remaining bytes go through the full decoder.
+ *  Optionally a base letter followed by a combining diacritic is composed into the precomposed letter (NFC).
+ *
+ *  \param in byte buffer
+ *  \param n number of bytes in the buffer
+ *  \param cps array of at least n positions to store the code points
+ *  \param nfc flag signaling canonical composition should be applied
+ *  \param nInvalid number of invalid sequences found
+ *
+ *  \return number of code points stored
+ */
+extern int decodeChunk (const unsigned char *in, int n, int *cps, bool nfc, int *nInvalid);
+
+#endif /* UTF8_H */
@@ -0,0 +1,115 @@
+/**
+ *  \file utils.c (implementation file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Helpers shared by the modules: the clock, critical regions which abort on failure, and files replaced whole.
+ *
+ *  Definition of the operations:
+ *     \li now
+ *     \li lock
+ *     \li unlock
+ *     \li replaceFile.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "utils.h"
+
+/**
+ *  \brief Get the current time.
+ *
+ *  \return time elapsed since an arbitrary fixed point, in seconds
+ */
+
+double now (void)
+{
+  struct timespec t;
+
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return (double) t.tv_sec + 1.0e-9 * (double) t.tv_nsec;
+}
+
+/**
+ *  \brief Enter a critical region, aborting on failure.
+ *
+ *  \param mutex locking flag of the region
+ *  \param region name of the region (for error reporting)
+ */
+
+void lock (pthread_mutex_t *mutex, const char *region)
+{
+  int status;
+
+  if ((status = pthread_mutex_lock (mutex)) != 0)
+     { fprintf (stderr, "error on entering the %s: %s\n", region, strerror (status));
+       exit (EXIT_FAILURE);
+     }
+}
+
+/**
+ *  \brief Exit a critical region, aborting on failure.
+ *
+ *  \param mutex locking flag of the region
+ *  \param region name of the region (for error reporting)
+ */
+
+void unlock (pthread_mutex_t *mutex, const char *region)
+{
+  int status;
+
+  if ((status = pthread_mutex_unlock (mutex)) != 0)
+     { fprintf (stderr, "error on exiting the %s: %s\n", region, strerror (status));
+       exit (EXIT_FAILURE);
+     }
+}
+
+/**
+ *  \brief Write a file whole, replacing the one there may be.
+ *
+ *  The contents are written to a temporary file, which is flushed to the disk and then renamed, so the file is
+ *  either complete or the previous one, even after a crash.
+ *
+ *  \param path name of the file
+ *  \param writeContents function which writes the contents to a stream, returning true on success
+ *  \param arg argument of writeContents
+ *
+ *  \return true on success, false with errno set otherwise
+ */
+
+bool replaceFile (const char *path, bool (*writeContents) (FILE *fp, void *arg), void *arg)
+{
+  char *tmpPath;                                                                   /* name of the temporary file */
+  FILE *fp;
+  bool ok;
+
+  if ((tmpPath = malloc (strlen (path) + 5)) == NULL)
+     { fprintf (stderr, "error on allocating space to the name of a temporary file\n");
+       exit (EXIT_FAILURE);
+     }
+  sprintf (tmpPath, "%s.tmp", path);
+  if ((fp = fopen (tmpPath, "wb")) == NULL)
+     { free (tmpPath);
+       return false;
+     }
+  ok = writeContents (fp, arg) && (fflush (fp) == 0) && (fsync (fileno (fp)) == 0);    /* on disk before renamed */
+  ok = (fclose (fp) == 0) && ok;
+  ok = ok && (rename (tmpPath, path) == 0);
+  if (!ok)                                                            /* no temporary file is left behind */
+     { int err = errno;
+       remove (tmpPath);
+       errno = err;
+     }
+  free (tmpPath);
+
+  return ok;
+}
@@ -0,0 +1,61 @@
+/**
+ *  \file utils.h (interface file)
+ *
+ *  \brief Problem name: Text processing in Portuguese
+ *
+ *  Helpers shared by the modules: the clock, critical regions which abort on failure, and files replaced whole.
+ *
+ *  Definition of the operations:
+ *     \li now
+ *     \li lock
+ *     \li unlock
+ *     \li replaceFile.
+ *
+ *  \author João Morais and Miguel Ferreira
+ */
+
+#ifndef UTILS_H
+#define UTILS_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+/**
+ *  \brief Get the current time.
+ *
+ *  \return time elapsed since an arbitrary fixed point, in seconds
+ */
+extern double now (void);
+
+/**
+ *  \brief Enter a critical region, aborting on failure.
+ *
+ *  \param mutex locking flag of the region
+ *  \param region name of the region (for error reporting)
+ */
+extern void lock (pthread_mutex_t *mutex, const char *region);
+
+/**
+ *  \brief Exit a critical region, aborting on failure.
+ *
+ *  \param mutex locking flag of the region
+ *  \param region name of the region (for error reporting)
+ */
+extern void unlock (pthread_mutex_t *mutex, const char *region);
+
+/**
+ *  \brief Write a file whole, replacing the one there may be.
+ *
+ *  The contents are written to a temporary file, which is flushed to the disk and then renamed, so the file is
+ *  either complete or the previous one, even after a crash.
+ *
+ *  \param path name of the file
+ *  \param writeContents function which writes the contents to a stream, returning true on success
+ *  \param arg argument of writeContents
+ *
+ *  \return true on success, false with errno set otherwise
+ */
+extern bool replaceFile (const char *path, bool (*writeContents) (FILE *fp, void *arg), void *arg);
+
+#endif /* UTILS_H */